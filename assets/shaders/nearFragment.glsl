@@ -6,46 +6,67 @@ in vec3 Normal;
 
 out vec4 FragColor;
 
-uniform float u_CullRadius;
+// filled once a frame for every object, has to look exactly like FrameData.hpp and the one in nearVertex.glsl
+const int MAX_LIGHTS = 127;
+struct FrameLight
+{
+    vec4 position;       // xyz is camera local
+    vec4 colorIntensity; // rgb is the color, a is the intensity
+};
+layout(std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec4 frameSettings; // x = gamma, y = full bright, z = number of lights
+    vec4 frameAmbient;  // rgb is the lights that didn't fit in lights
+    FrameLight lights[MAX_LIGHTS];
+};
+
+uniform vec3 uDepth; // z is the cull radius
 uniform sampler2D texture1;
 uniform vec3 emissionColor;
 uniform float emissionIntensity;
 
-const int MAX_LIGHTS = 127;
-uniform int numLights;
-uniform vec3 lightPositions[MAX_LIGHTS];
-uniform vec3 lightColors[MAX_LIGHTS];
-uniform float lightIntensities[MAX_LIGHTS];
-
-uniform float gamma;
-uniform bool u_fullBright;
+// the brightest few lights for this object, picked by LightSelector, everything else is in uAmbient
+const int MAX_OBJECT_LIGHTS = 8;
+uniform int uLightCount;
+uniform int uLights[MAX_OBJECT_LIGHTS];
+uniform vec3 uAmbient;
 
 void main()
 {
-    if (length(FragPos) < u_CullRadius) discard;
+    if (length(FragPos) < uDepth.z) discard;
+
+    float gamma = frameSettings.x;
+    bool fullBright = frameSettings.y > 0.5;
 
     vec3 norm = normalize(Normal);
     vec3 viewDir = normalize(-FragPos);
     vec3 texColor = texture(texture1, TexCoord).rgb;
     vec3 finalColor = vec3(0.0);
 
-    if (!u_fullBright) {
-        vec3 lighting = vec3(0.0);
-        // Directional Light
-        for (int i = 0; i < numLights; i++)
+    if (!fullBright) {
+        vec3 lighting = uAmbient + frameAmbient.rgb;
+        for (int j = 0; j < uLightCount; j++)
         {
-            vec3 lightDir = normalize(-lightPositions[i]);
+            int i = uLights[j];
+
+            vec3 toLight = lights[i].position.xyz - FragPos;
+            float distanceSquared = max(dot(toLight, toLight), 1e-6);
+            vec3 lightDir = normalize(toLight);
+            vec3 lightColor = lights[i].colorIntensity.rgb;
+            float lightIntensity = lights[i].colorIntensity.a / distanceSquared;
 
             float ambientStrength = 0.1;
-            vec3 ambient = ambientStrength * lightColors[i] * lightIntensities[i];
+            vec3 ambient = ambientStrength * lightColor * lightIntensity;
 
             float diff = max(dot(norm, lightDir), 0.0);
-            vec3 diffuse = diff * lightColors[i] * lightIntensities[i];
+            vec3 diffuse = diff * lightColor * lightIntensity;
 
             float specularStrength = 0.5;
             vec3 reflectDir = reflect(-lightDir, norm);
             float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
-            vec3 specular = specularStrength * spec * lightColors[i] * lightIntensities[i];
+            vec3 specular = specularStrength * spec * lightColor * lightIntensity;
 
             lighting += ambient + diffuse + specular;
         }
@@ -0,0 +1,80 @@
+#version 330 core
+
+in vec2 TexCoord;
+in vec3 FragPos;
+in vec3 Normal;
+flat in vec4 Emission;
+flat in float CullRadius;
+flat in vec3 Ambient;
+flat in ivec4 LightsA;
+flat in ivec4 LightsB;
+
+out vec4 FragColor;
+
+// filled once a frame for every object, has to look exactly like FrameData.hpp and the one in nearInstancedVertex.glsl
+const int MAX_LIGHTS = 127;
+struct FrameLight
+{
+    vec4 position;       // xyz is camera local
+    vec4 colorIntensity; // rgb is the color, a is the intensity
+};
+layout(std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec4 frameSettings; // x = gamma, y = full bright, z = number of lights
+    vec4 frameAmbient;  // rgb is the lights that didn't fit in lights
+    FrameLight lights[MAX_LIGHTS];
+};
+
+uniform sampler2D texture1;
+
+const int MAX_OBJECT_LIGHTS = 8;
+
+// the same lighting as nearFragment.glsl, the per object stuff just comes in from the vertex shader
+void main()
+{
+    if (length(FragPos) < CullRadius) discard;
+
+    float gamma = frameSettings.x;
+    bool fullBright = frameSettings.y > 0.5;
+
+    vec3 norm = normalize(Normal);
+    vec3 viewDir = normalize(-FragPos);
+    vec3 texColor = texture(texture1, TexCoord).rgb;
+    vec3 emission = Emission.rgb * Emission.a;
+    vec3 finalColor = vec3(0.0);
+
+    if (!fullBright) {
+        vec3 lighting = Ambient + frameAmbient.rgb;
+        for (int j = 0; j < MAX_OBJECT_LIGHTS; j++)
+        {
+            int i = j < 4 ? LightsA[j] : LightsB[j - 4];
+            if (i < 0) break;
+
+            vec3 toLight = lights[i].position.xyz - FragPos;
+            float distanceSquared = max(dot(toLight, toLight), 1e-6);
+            vec3 lightDir = normalize(toLight);
+            vec3 lightColor = lights[i].colorIntensity.rgb;
+            float lightIntensity = lights[i].colorIntensity.a / distanceSquared;
+
+            float ambientStrength = 0.1;
+            vec3 ambient = ambientStrength * lightColor * lightIntensity;
+
+            float diff = max(dot(norm, lightDir), 0.0);
+            vec3 diffuse = diff * lightColor * lightIntensity;
+
+            float specularStrength = 0.5;
+            vec3 reflectDir = reflect(-lightDir, norm);
+            float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);
+            vec3 specular = specularStrength * spec * lightColor * lightIntensity;
+
+            lighting += ambient + diffuse + specular;
+        }
+        finalColor = lighting * texColor + emission;
+    }
+    else {
+        finalColor = texColor + emission;
+    }
+    FragColor = vec4(pow(finalColor, vec3(1.0 / gamma)), 1.0);
+}
@@ -0,0 +1,57 @@
+#version 330 core
+layout(location = 0) in vec3 aPos;
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec3 aNormal;
+
+// per instance, has to match InstanceData.hpp and OpenGlBackend::setupInstanceBuffer
+layout(location = 3) in mat4 iModel;
+layout(location = 7) in vec4 iEmission;
+layout(location = 8) in vec4 iDepth;
+layout(location = 9) in vec4 iAmbient;
+layout(location = 10) in ivec4 iLightsA;
+layout(location = 11) in ivec4 iLightsB;
+
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 Normal;
+flat out vec4 Emission;
+flat out float CullRadius;
+flat out vec3 Ambient;
+flat out ivec4 LightsA;
+flat out ivec4 LightsB;
+
+// filled once a frame for every object, has to look exactly like FrameData.hpp and the one in nearInstancedFragment.glsl
+const int MAX_LIGHTS = 127;
+struct FrameLight
+{
+    vec4 position;       // xyz is camera local
+    vec4 colorIntensity; // rgb is the color, a is the intensity
+};
+layout(std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec4 frameSettings; // x = gamma, y = full bright, z = number of lights
+    vec4 frameAmbient;  // rgb is the lights that didn't fit in lights
+    FrameLight lights[MAX_LIGHTS];
+};
+
+void main()
+{
+    // same as nearVertex.glsl but everything per object comes from the instance attributes
+    mat4 projection = uProjection;
+    projection[2][2] = iDepth.x;
+    projection[3][2] = iDepth.y;
+
+    gl_Position = projection * uView * iModel * vec4(aPos, 1.0);
+    FragPos = vec3(iModel * vec4(aPos, 1.0));
+
+    Normal = normalize(mat3(transpose(inverse(iModel))) * aNormal);
+
+    TexCoord = aTexCoord;
+    Emission = iEmission;
+    CullRadius = iDepth.z;
+    Ambient = iAmbient.rgb;
+    LightsA = iLightsA;
+    LightsB = iLightsB;
+}
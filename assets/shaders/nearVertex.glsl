@@ -7,13 +7,32 @@ out vec2 TexCoord;
 out vec3 FragPos;
 out vec3 Normal;
 
+// filled once a frame for every object, has to look exactly like FrameData.hpp and the one in nearFragment.glsl
+const int MAX_LIGHTS = 127;
+struct FrameLight
+{
+    vec4 position;       // xyz is camera local
+    vec4 colorIntensity; // rgb is the color, a is the intensity
+};
+layout(std140) uniform FrameData
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec4 frameSettings; // x = gamma, y = full bright, z = number of lights
+    vec4 frameAmbient;  // rgb is the lights that didn't fit in lights
+    FrameLight lights[MAX_LIGHTS];
+};
+
 uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+uniform vec3 uDepth; // x and y replace the projection's depth part since near and far are per object, z is the cull radius
 
 void main()
 {
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0);
+    mat4 projection = uProjection;
+    projection[2][2] = uDepth.x;
+    projection[3][2] = uDepth.y;
+
+    gl_Position = projection * uView * uModel * vec4(aPos, 1.0);
     FragPos = vec3(uModel * vec4(aPos, 1.0));
     
     Normal = normalize(mat3(transpose(inverse(uModel))) * aNormal);
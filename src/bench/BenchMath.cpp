@@ -0,0 +1,348 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "Camera.hpp"
+#include "customMath/BigMath.hpp"
+#include "customMath/BigVec3Array.hpp"
+
+// times the big number math on its own, no SDL or GL needed
+// usage: bench_math [--iterations N] [--json out.json] [--baseline old.json] [--tolerance 0.10]
+// with --baseline it exits with 1 if anything got slower than the tolerance, started allocating more or stopped running,
+// and with 2 if the baseline file is missing or has no results in it
+
+// counts every heap allocation so each benchmark can report allocations per op
+static std::atomic<uint64_t> allocationCount{0};
+
+void *operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+// stops the compiler from throwing away work whose result nobody reads
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Result
+{
+    std::string name;
+    std::string magnitude;
+    uint64_t iterations;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+struct Magnitude
+{
+    std::string name;
+    std::string value;
+};
+
+template <typename Fn>
+Result run(const std::string &name, const std::string &magnitude, uint64_t iterations, Fn fn)
+{
+    // warm up so the first run doesn't pay for cold caches
+    for (uint64_t i = 0; i < iterations / 10 + 1; i++)
+        fn();
+
+    uint64_t allocationsBefore = allocationCount.load();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; i++)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    uint64_t allocations = allocationCount.load() - allocationsBefore;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return Result{name, magnitude, iterations, ns / iterations, static_cast<double>(allocations) / iterations};
+}
+
+void writeJson(const std::vector<Result> &results, std::ostream &out)
+{
+    out << "{\n";
+    out << "  \"benchmark\": \"bench_math\",\n";
+    out << "  \"frac_bits\": " << Bigint::FRAC_BITS << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const Result &r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"magnitude\": \"" << r.magnitude
+            << "\", \"iterations\": " << r.iterations
+            << ", \"ns_per_op\": " << std::fixed << std::setprecision(3) << r.nsPerOp
+            << ", \"allocs_per_op\": " << r.allocsPerOp << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// pulls "key": value out of one result line, this only has to read what writeJson writes
+std::string jsonField(const std::string &line, const std::string &key)
+{
+    size_t at = line.find("\"" + key + "\":");
+    if (at == std::string::npos)
+        return "";
+    at = line.find_first_not_of(' ', at + key.size() + 3);
+    if (line[at] == '"')
+        return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+    return line.substr(at, line.find_first_of(",}", at) - at);
+}
+
+// throws if the file can't be opened, an empty list back means there were no results in it
+std::vector<Result> readJson(const std::string &path)
+{
+    std::vector<Result> results;
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("can't open " + path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.find("\"ns_per_op\"") == std::string::npos)
+            continue;
+        results.push_back(Result{
+            jsonField(line, "name"),
+            jsonField(line, "magnitude"),
+            std::stoull(jsonField(line, "iterations")),
+            std::stod(jsonField(line, "ns_per_op")),
+            std::stod(jsonField(line, "allocs_per_op"))});
+    }
+    return results;
+}
+
+// prints every regression and returns how many there were, a case the baseline has that didn't run counts as one
+int compareToBaseline(const std::vector<Result> &results, const std::vector<Result> &baseline, double tolerance)
+{
+    int regressions = 0;
+    for (const Result &old : baseline)
+    {
+        bool found = false;
+        for (const Result &now : results)
+        {
+            if (now.name != old.name || now.magnitude != old.magnitude)
+                continue;
+            found = true;
+
+            if (now.nsPerOp > old.nsPerOp * (1.0 + tolerance))
+            {
+                std::cerr << "REGRESSION " << now.name << "/" << now.magnitude << ": " << old.nsPerOp << " -> " << now.nsPerOp << " ns/op\n";
+                regressions++;
+            }
+            if (now.allocsPerOp > old.allocsPerOp + 0.01)
+            {
+                std::cerr << "REGRESSION " << now.name << "/" << now.magnitude << ": " << old.allocsPerOp << " -> " << now.allocsPerOp << " allocs/op\n";
+                regressions++;
+            }
+        }
+        if (!found)
+        {
+            std::cerr << "MISSING " << old.name << "/" << old.magnitude << ": in the baseline but not in this run\n";
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+// the batch conversion has to give exactly the floats the scalar one does, so before timing anything this runs both
+// over values either side of the origin from millimetres to thousands of km, returns how many came out different
+int checkBatchToFloat()
+{
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> exponent(-4.0, 7.0);
+    std::bernoulli_distribution negative(0.5);
+    auto randomValue = [&]
+    {
+        double v = std::pow(10.0, exponent(rng));
+        return Bigint(negative(rng) ? -v : v);
+    };
+
+    BigVec3 origin(Bigint(12.375), Bigint(-3.0), Bigint(0));
+    BigVec3Array values;
+    std::vector<BigVec3> scalar;
+    for (int i = 0; i < 100000; i++)
+    {
+        scalar.push_back(BigVec3(randomValue(), randomValue(), randomValue()));
+        values.push(scalar.back());
+    }
+
+    std::vector<glm::vec3> batch(scalar.size());
+    values.toFloat(batch.data(), origin);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < scalar.size(); i++)
+    {
+        glm::vec3 expected((scalar[i].x - origin.x).toFloat(), (scalar[i].y - origin.y).toFloat(), (scalar[i].z - origin.z).toFloat());
+        if (batch[i] != expected)
+        {
+            if (mismatches++ < 5)
+                std::cerr << "MISMATCH soa to_float entry " << i << ": " << batch[i].x << " " << batch[i].y << " " << batch[i].z
+                          << " should be " << expected.x << " " << expected.y << " " << expected.z << "\n";
+        }
+    }
+    return mismatches;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t iterations = 200000;
+    std::string jsonPath;
+    std::string baselinePath;
+    double tolerance = 0.10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc)
+            iterations = std::stoull(argv[++i]);
+        else if (arg == "--json" && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (arg == "--baseline" && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = std::stod(argv[++i]);
+        else
+        {
+            std::cerr << "usage: bench_math [--iterations N] [--json out.json] [--baseline old.json] [--tolerance 0.10]\n";
+            return 2;
+        }
+    }
+
+    // from walking around up to the googol meters thing in main.cpp
+    std::vector<Magnitude> magnitudes = {
+        {"metres", "1.5"},
+        {"kilometres", "1500.25"},
+        {"au", "149597870700"},
+        {"lightyear", "9460730472580800"},
+        {"googol", "1" + std::string(100, '0')},
+    };
+
+    if (int mismatches = checkBatchToFloat())
+    {
+        std::cerr << mismatches << " batch to_float result(s) differ from the scalar path\n";
+        return 1;
+    }
+
+    std::vector<Result> results;
+    const float deltaTime = 1.0f / 60.0f;
+
+    for (const Magnitude &m : magnitudes)
+    {
+        Bigint a(m.value);
+        Bigint b = a / Bigint(3.5);
+        Bigint small(1.0001);
+        BigVec3 position(a, b, a);
+        BigVec3 velocity(Bigint(2.5f), Bigint(-1.0f), Bigint(0.5f));
+        BigVec3 offset(b, a, Bigint(7));
+        Bigint intensity("384600000000000000000000000");
+        Camera camera(glm::vec2(800, 600), b, a, b);
+
+        results.push_back(run("construct_string", m.name, iterations, [&]
+                              { Bigint r(m.value); doNotOptimize(r); }));
+        results.push_back(run("add", m.name, iterations, [&]
+                              { Bigint r = a + b; doNotOptimize(r); }));
+        results.push_back(run("subtract", m.name, iterations, [&]
+                              { Bigint r = a - b; doNotOptimize(r); }));
+        results.push_back(run("multiply", m.name, iterations, [&]
+                              { Bigint r = a * small; doNotOptimize(r); }));
+        results.push_back(run("divide", m.name, iterations, [&]
+                              { Bigint r = a / small; doNotOptimize(r); }));
+        results.push_back(run("to_float", m.name, iterations, [&]
+                              { float r = a.toFloat(); doNotOptimize(r); }));
+        results.push_back(run("to_double", m.name, iterations, [&]
+                              { double r = a.toDouble(); doNotOptimize(r); }));
+        results.push_back(run("vec3_add", m.name, iterations, [&]
+                              { BigVec3 r = position + offset; doNotOptimize(r); }));
+        // gets its own copy so the cases after it start from the same position
+        BigVec3 integrated = position;
+        results.push_back(run("vec3_integrate", m.name, iterations, [&]
+                              { integrated += velocity * deltaTime; doNotOptimize(integrated); }));
+        results.push_back(run("camera_to_local", m.name, iterations, [&]
+                              { glm::vec3 r = camera.convertToLocal(position); doNotOptimize(r); }));
+        results.push_back(run("inverse_square", m.name, iterations, [&]
+                              { float r = bigMath::inverseSquare(intensity, offset); doNotOptimize(r); }));
+        results.push_back(run("normalize", m.name, iterations, [&]
+                              { glm::vec3 r = bigMath::normalizeToFloat(offset); doNotOptimize(r); }));
+        results.push_back(run("length", m.name, iterations, [&]
+                              { Bigint r = bigMath::length(offset); doNotOptimize(r); }));
+
+        // the batch kernels do a whole array per op, so these are timed per 1024 entities
+        const size_t batch = 1024;
+        BigVec3Array positions, velocities;
+        std::vector<glm::vec3> local(batch);
+        for (size_t i = 0; i < batch; i++)
+        {
+            positions.push(position);
+            velocities.push(velocity);
+        }
+        uint64_t batchIterations = iterations / batch + 1;
+        results.push_back(run("soa_integrate_1024", m.name, batchIterations, [&]
+                              { positions.addScaled(velocities, deltaTime); doNotOptimize(positions); }));
+        results.push_back(run("soa_to_local_1024", m.name, batchIterations, [&]
+                              { positions.toFloat(local.data(), camera.position); doNotOptimize(local); }));
+    }
+
+    std::cout << std::left << std::setw(20) << "benchmark" << std::setw(12) << "magnitude"
+              << std::right << std::setw(12) << "ns/op" << std::setw(14) << "allocs/op" << "\n";
+    for (const Result &r : results)
+    {
+        std::cout << std::left << std::setw(20) << r.name << std::setw(12) << r.magnitude
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(2) << r.nsPerOp
+                  << std::setw(14) << std::setprecision(3) << r.allocsPerOp << "\n";
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream out(jsonPath);
+        writeJson(results, out);
+    }
+
+    if (!baselinePath.empty())
+    {
+        // a baseline that isn't there has to fail, otherwise a typo in the path looks like a clean run
+        std::vector<Result> baseline;
+        try
+        {
+            baseline = readJson(baselinePath);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "bad baseline: " << e.what() << "\n";
+            return 2;
+        }
+        if (baseline.empty())
+        {
+            std::cerr << "bad baseline: no results in " << baselinePath << "\n";
+            return 2;
+        }
+
+        int regressions = compareToBaseline(results, baseline, tolerance);
+        std::cout << regressions << " regression(s) against " << baselinePath << "\n";
+        return regressions == 0 ? 0 : 1;
+    }
+    return 0;
+}
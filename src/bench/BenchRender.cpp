@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "RenderObject.h"
+#include "InstanceBatcher.hpp"
+#include "JobSystem.hpp"
+#include "Camera.hpp"
+#include "headless/HeadlessBackend.hpp"
+#include "headless/HelperFunctionsHeadless.hpp"
+
+// runs the same frame main.cpp does (update, camera, lights, batching, render queue) on the headless backend,
+// so the cpu side of drawing can be timed and checked without a gpu
+// usage: bench_render [--objects N] [--frames N] [--no-batching] [--log out.txt]
+//                     [--expect-draws N] [--expect-shader-changes N] [--expect-texture-changes N]
+// with any --expect it exits with 1 if the last frame didn't do exactly that many
+
+// -1 means don't check
+bool check(const std::string &name, int64_t expected, uint64_t actual)
+{
+    if (expected < 0 || static_cast<uint64_t>(expected) == actual)
+        return true;
+    std::cerr << "MISMATCH " << name << ": expected " << expected << ", got " << actual << "\n";
+    return false;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t objectCount = 10000;
+    int frames = 200;
+    bool batching = true;
+    std::string logPath;
+    int64_t expectDraws = -1;
+    int64_t expectShaderChanges = -1;
+    int64_t expectTextureChanges = -1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--objects" && i + 1 < argc)
+            objectCount = std::stoull(argv[++i]);
+        else if (arg == "--frames" && i + 1 < argc)
+            frames = std::stoi(argv[++i]);
+        else if (arg == "--no-batching")
+            batching = false;
+        else if (arg == "--log" && i + 1 < argc)
+            logPath = argv[++i];
+        else if (arg == "--expect-draws" && i + 1 < argc)
+            expectDraws = std::stoll(argv[++i]);
+        else if (arg == "--expect-shader-changes" && i + 1 < argc)
+            expectShaderChanges = std::stoll(argv[++i]);
+        else if (arg == "--expect-texture-changes" && i + 1 < argc)
+            expectTextureChanges = std::stoll(argv[++i]);
+        else
+        {
+            std::cerr << "usage: bench_render [--objects N] [--frames N] [--no-batching] [--log out.txt]\n"
+                      << "                    [--expect-draws N] [--expect-shader-changes N] [--expect-texture-changes N]\n";
+            return 2;
+        }
+    }
+
+    JobSystem jobs;
+    Camera camera(glm::vec2(800, 600));
+    HelperFunctionsHeadless renderer;
+    CommandLog &log = renderer.getLog();
+    log.recording = !logPath.empty(); // the counters are enough unless someone wants to read it
+
+    ShaderHeadless shader;
+    ShaderHeadless instancedShader;
+    ImageHeadless images[2];
+    InstanceBatcher batcher;
+    if (batching)
+        batcher.addVariant(&shader, &instancedShader);
+
+    // a block of cubes in front of the camera, every 64th one glows and every other one has the other texture
+    std::vector<std::unique_ptr<RenderObject>> owned;
+    std::vector<RenderObject *> objects;
+    size_t side = 1;
+    while (side * side * side < objectCount)
+        side++;
+    for (size_t i = 0; i < objectCount; i++)
+    {
+        Bigint glow = i % 64 == 0 ? Bigint(50) : Bigint();
+        owned.emplace_back(new RenderObject(new HeadlessBackend(), &shader, &images[i % 2], &camera, glm::vec3(1.0f), glow));
+        RenderObject *object = owned.back().get();
+        object->setPosition(BigVec3(Bigint(static_cast<int>(i % side) * 3 - static_cast<int>(side) * 3 / 2),
+                                   Bigint(static_cast<int>(i / side % side) * 3 - static_cast<int>(side) * 3 / 2),
+                                   Bigint(static_cast<int>(i / (side * side)) * 3 + 20)));
+        object->setFar(100000.0f);
+        objects.push_back(object);
+    }
+    RenderObject::updateTransforms();
+
+    const float step = 1.0f / 60.0f;
+    double updateNs = 0.0;
+    double submitNs = 0.0;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        RenderObject::entities.integrate(step, RenderObject::scene, jobs);
+        RenderObject::updateTransforms();
+        camera.updateLocalPositions(jobs);
+        RenderObject::uploadFrameData(camera, &renderer);
+        auto middle = std::chrono::steady_clock::now();
+
+        renderer.clearBackground();
+        batcher.submit(objects, &jobs);
+        RenderObject::renderQueue.flush(&renderer, jobs);
+        renderer.swapBuffer();
+        auto end = std::chrono::steady_clock::now();
+
+        updateNs += std::chrono::duration<double, std::nano>(middle - start).count();
+        submitNs += std::chrono::duration<double, std::nano>(end - middle).count();
+    }
+
+    const CommandCounters &last = log.getLastFrame();
+    std::cout << objectCount << " objects, " << frames << " frames, batching " << (batching ? "on" : "off") << "\n";
+    std::cout << std::fixed << std::setprecision(3)
+              << "update ms/frame     " << updateNs / frames / 1e6 << "\n"
+              << "submit ms/frame     " << submitNs / frames / 1e6 << "\n"
+              << "draws               " << last.draws << " (" << last.instancedDraws << " instanced, " << last.instances << " instances)\n"
+              << "vertices            " << last.vertices << "\n"
+              << "shader changes      " << last.shaderChanges << "\n"
+              << "texture changes     " << last.textureChanges << "\n"
+              << "redundant binds     " << last.redundantBinds << "\n"
+              << "uniform sets        " << last.uniformSets << "\n";
+
+    if (!logPath.empty())
+    {
+        std::ofstream out(logPath);
+        log.dump(out);
+    }
+
+    bool ok = check("draws", expectDraws, last.draws);
+    ok = check("shader changes", expectShaderChanges, last.shaderChanges) && ok;
+    ok = check("texture changes", expectTextureChanges, last.textureChanges) && ok;
+    return ok ? 0 : 1;
+}
@@ -2,24 +2,62 @@
 
 #include <vector>
 #include <string>
+#include <glm/glm.hpp>
 #include "HelperFunctions.hpp"
+#include "Uniforms.hpp"
+#include "InstanceData.hpp"
 
 class Backend
 {
 public:
     virtual ~Backend() = default;
 
-    virtual void setupObject(const std::vector<float> &verts) = 0;
-    virtual void updateVerts(const std::vector<float> &verts) = 0;
+    // uploads verts, this only gets called by MeshRegistry the first time it sees a mesh
+    virtual MeshBuffer *createMeshBuffer(const std::vector<float> &verts) = 0;
+
+    // the mesh this object draws, it's shared so the backend doesn't own it
+    virtual void setupObject(MeshBuffer *mesh) = 0;
     virtual void includeShader(Shader *shader) = 0;
     virtual void includeTexture(Image *image) = 0;
-    virtual void includeFloat(const std::string &location, const float f) = 0;
-    virtual void finalizeShaders(const std::vector<float> &vertices) = 0;
-    virtual void includeMat4(const std::string &name, const glm::mat4 &mat) = 0;
-    virtual void includeTripleFloat(const std::string &location, const float f1, const float f2, const float f3) = 0;
-    virtual void includeInt(const std::string &location, const int i) = 0;
-    virtual void includeBool(const std::string &location, const bool b) = 0;
+    virtual void finalizeShaders() = 0;
+
+    // draws the mesh once for every instance in one go, the shader has to be an instanced one
+    virtual void drawInstanced(const std::vector<InstanceData> &instances) = 0;
+
+    // these take ids from UniformNames, get them once up front and keep them around
+    virtual void includeFloat(UniformId location, const float f) = 0;
+    virtual void includeMat4(UniformId location, const glm::mat4 &mat) = 0;
+    virtual void includeTripleFloat(UniformId location, const float f1, const float f2, const float f3) = 0;
+    virtual void includeInt(UniformId location, const int i) = 0;
+    virtual void includeBool(UniformId location, const bool b) = 0;
+
+    // the string versions still work but they look the name up every call, so keep them out of anything hot
+    void includeFloat(const std::string &location, const float f)
+    {
+        includeFloat(UniformNames::get(location), f);
+    }
+
+    void includeMat4(const std::string &name, const glm::mat4 &mat)
+    {
+        includeMat4(UniformNames::get(name), mat);
+    }
+
+    void includeTripleFloat(const std::string &location, const float f1, const float f2, const float f3)
+    {
+        includeTripleFloat(UniformNames::get(location), f1, f2, f3);
+    }
+
+    void includeInt(const std::string &location, const int i)
+    {
+        includeInt(UniformNames::get(location), i);
+    }
+
+    void includeBool(const std::string &location, const bool b)
+    {
+        includeBool(UniformNames::get(location), b);
+    }
 
 protected:
     Shader *shader = nullptr;
+    MeshBuffer *mesh = nullptr;
 };
\ No newline at end of file
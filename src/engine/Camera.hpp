@@ -1,5 +1,13 @@
 #pragma once
 #include "customMath/BigVec.hpp"
+#include "customMath/BigVec3Array.hpp"
+#include "customMath/BigMath.hpp"
+#include <cmath>
+#include <climits>
+#include <vector>
+#include <algorithm>
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtx/quaternion.hpp>
@@ -16,7 +24,18 @@ public:
 
     float fov = 90.0f; // if this number isn't 90 then your not a man (or your zooming in which is chill but only if your zooming in)
 
-    Camera(const glm::vec2 &RES, Bigint x = Bigint(0), Bigint y = Bigint(0), Bigint z = Bigint(0)) : position(BigVec3(x, y, z)), RES(RES) {}
+    // floating origin: tracked positions near the anchor get cached as double offsets from it, so nearby stuff only costs
+    // a double subtract a frame and the Bigint work only happens when something moves, for far stuff, or when the anchor moves
+    bool floatingOrigin = false;
+    double floatingOriginRadius = 1.0e7; // anything further than this from the anchor just does the normal Bigint convert
+    double rebaseDistance = 1.0e4;       // the anchor jumps to the camera once the camera gets this far away from it
+    BigVec3 anchor;
+    unsigned rebaseCount = 0; // how many times the anchor moved, handy for debugging
+
+    Camera(const glm::vec2 &RES, Bigint x = Bigint(0), Bigint y = Bigint(0), Bigint z = Bigint(0)) : position(BigVec3(x, y, z)), RES(RES)
+    {
+        updateFrustum();
+    }
 
     glm::mat4 getViewMatrix() const
     {
@@ -30,6 +49,14 @@ public:
         return glm::perspective(glm::radians(fov), RES.x / RES.y, near, far);
     }
 
+    // the two parts of the projection that depend on near and far ([2][2] and [3][2]),
+    // everything else is the same for every object so it goes in the per frame buffer
+    glm::vec2 getDepthParameters(float near, float far) const
+    {
+        glm::mat4 projection = getProjectionMatrix(near, far);
+        return glm::vec2(projection[2][2], projection[3][2]);
+    }
+
     // it gets the vector right in front
     glm::vec3 getForwardVector() const
     {
@@ -64,7 +91,198 @@ public:
         return (position - otherPosition).toFloatVec3();
     }
 
+    // registers entry index of positions to get converted every frame by updateLocalPositions, gives back its slot
+    int trackPosition(const BigVec3Array *positions, size_t index)
+    {
+        if (!freeSlots.empty())
+        {
+            int slot = freeSlots.back();
+            freeSlots.pop_back();
+            trackedPositions[slot] = {positions, index};
+            moved[slot] = 1;
+            return slot;
+        }
+        trackedPositions.push_back({positions, index});
+        localPositions.emplace_back(0.0f);
+        magnitudes.push_back(NO_MAGNITUDE);
+        anchorOffsets.emplace_back(0.0);
+        nearAnchor.push_back(0);
+        moved.push_back(1);
+        return static_cast<int>(trackedPositions.size()) - 1;
+    }
+
+    void untrackPosition(int slot)
+    {
+        trackedPositions[slot] = TrackedPosition();
+        freeSlots.push_back(slot);
+    }
+
+    // the position in this slot got moved to another index in its array, like when EntityStore swaps a row into a hole
+    void retrackPosition(int slot, size_t index)
+    {
+        trackedPositions[slot].index = index;
+    }
+
+    // tells the camera the position in this slot changed, only matters with floatingOrigin on
+    // RenderObject::Update calls it, call it yourself if you move something some other way
+    void markMoved(int slot)
+    {
+        moved[slot] = 1;
+    }
+
+    // converts every tracked position to camera local floats in one go, run it once a frame after everything moved
+    // and before anything draws, the Bigint work gets split over the job system since nothing else touches it
+    void updateLocalPositions(JobSystem &jobs)
+    {
+        beginUpdate();
+        jobs.parallelFor(trackedPositions.size(), MIN_POSITIONS_PER_THREAD, [this](size_t begin, size_t end)
+                         { convertRange(begin, end); });
+    }
+
+    // what updateLocalPositions worked out for the slot
+    const glm::vec3 &getLocalPosition(int slot) const
+    {
+        return localPositions[slot];
+    }
+
+    // whether a sphere around the slot's position could be on screen for something drawn with this near and far
+    // first a Bigint size check so stuff way out past far never gets near a float, then the sphere against the frustum planes
+    // camera->updateLocalPositions() has to have run this frame
+    bool isVisible(int slot, float radius, float near, float far) const
+    {
+        // a component with m bits before the point is at least 2^(m-1) away
+        int magnitude = magnitudes[slot];
+        if (magnitude != NO_MAGNITUDE && std::ldexp(1.0, magnitude - 1) > static_cast<double>(far) + radius)
+            return false;
+
+        const glm::vec3 &p = localPositions[slot];
+        float depth = glm::dot(glm::vec3(forwardPlane), p);
+        if (depth + radius < near || depth - radius > far)
+            return false;
+        for (const glm::vec4 &plane : sidePlanes)
+        {
+            if (glm::dot(glm::vec3(plane), p) + plane.w < -radius)
+                return false;
+        }
+        return true;
+    }
+
+    // every slot in one array, empty slots are left as whatever they were
+    const std::vector<glm::vec3> &getLocalPositions() const
+    {
+        return localPositions;
+    }
+
 private:
+    static constexpr size_t MIN_POSITIONS_PER_THREAD = 256; // below this starting a thread costs more than it saves
+    static constexpr int NO_MAGNITUDE = INT_MIN;            // the slot came from the floating origin cache, so it's close enough for floats
+
+    struct TrackedPosition
+    {
+        const BigVec3Array *positions = nullptr; // nullptr for a free slot
+        size_t index = 0;
+
+        BigVec3 get() const { return positions->get(index); }
+    };
+
+    std::vector<TrackedPosition> trackedPositions;
+    std::vector<glm::vec3> localPositions;
+    std::vector<int> magnitudes; // how many bits the biggest local component has before the point, from the Bigint
+    std::vector<int> freeSlots;
+
+    // the floating origin cache, one entry per slot
+    std::vector<glm::dvec3> anchorOffsets; // tracked position - anchor
+    std::vector<uint8_t> nearAnchor;       // 1 when anchorOffsets is good to use
+    std::vector<uint8_t> moved;            // 1 when anchorOffsets needs working out again
+    glm::dvec3 cameraAnchorOffset = glm::dvec3(0.0);
+    bool anchorSet = false;
+    bool rebasedThisFrame = false;
+
+    // the once a frame bit before the positions get converted
+    void beginUpdate()
+    {
+        rebasedThisFrame = false;
+        updateFrustum();
+        if (floatingOrigin)
+        {
+            // the one Bigint subtract the camera pays per frame
+            cameraAnchorOffset = (position - anchor).toDoubleVec3();
+            if (!anchorSet || glm::length(cameraAnchorOffset) > rebaseDistance)
+            {
+                anchor = position;
+                anchorSet = true;
+                cameraAnchorOffset = glm::dvec3(0.0);
+                rebasedThisFrame = true;
+                rebaseCount++;
+            }
+        }
+    }
+
+    // the frustum in camera local space, the sides don't care about near and far so they're shared by every object
+    glm::vec4 sidePlanes[4];
+    glm::vec4 forwardPlane; // dot with a position gives how far in front of the camera it is
+
+    void updateFrustum()
+    {
+        // near and far don't change the side planes so anything works here
+        glm::mat4 view = getViewMatrix();
+        glm::mat4 m = getProjectionMatrix(0.1f, 10000.0f) * view;
+        auto row = [&](int i)
+        {
+            return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+        };
+
+        // left, right, bottom, top
+        sidePlanes[0] = row(3) + row(0);
+        sidePlanes[1] = row(3) - row(0);
+        sidePlanes[2] = row(3) + row(1);
+        sidePlanes[3] = row(3) - row(1);
+        for (glm::vec4 &plane : sidePlanes)
+            plane = plane / glm::length(glm::vec3(plane));
+
+        // the view looks down -z
+        forwardPlane = -glm::vec4(view[0][2], view[1][2], view[2][2], 0.0f);
+    }
+
+    // the Bigint way, for when the floating origin cache can't be used
+    void convertFar(size_t i)
+    {
+        BigVec3 offset(position - trackedPositions[i].get());
+        localPositions[i] = offset.toFloatVec3();
+        magnitudes[i] = static_cast<int>(bigMath::maxBitLength(offset)) - Bigint::FRAC_BITS;
+    }
+
+    void convertRange(size_t begin, size_t end)
+    {
+        PROFILE_ZONE("convertToLocal");
+        for (size_t i = begin; i < end; i++)
+        {
+            if (trackedPositions[i].positions == nullptr)
+                continue;
+
+            if (!floatingOrigin)
+            {
+                convertFar(i);
+                continue;
+            }
+
+            if (moved[i] || rebasedThisFrame)
+            {
+                anchorOffsets[i] = (trackedPositions[i].get() - anchor).toDoubleVec3();
+                nearAnchor[i] = glm::length(anchorOffsets[i]) <= floatingOriginRadius;
+                moved[i] = 0;
+            }
+
+            if (nearAnchor[i])
+            {
+                localPositions[i] = glm::vec3(cameraAnchorOffset - anchorOffsets[i]);
+                magnitudes[i] = NO_MAGNITUDE;
+            }
+            else
+                convertFar(i);
+        }
+    }
+
     // it gets all them rotation craziness
     glm::mat4 getRotationMatrix() const
     {
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include "Backend.hpp"
+#include "HelperFunctions.hpp"
+#include "InstanceData.hpp"
+
+// backend calls written down into one flat array of bytes so they can be worked out on any thread
+// and then played back in order on the one thread that owns the gl context
+// each command is a small header (what, which backend, which uniform) followed by its arguments
+// clear keeps the memory, so after the first few frames recording doesn't allocate
+class CommandBuffer
+{
+public:
+    void includeShader(Backend *backend, Shader *shader)
+    {
+        header(Op::Shader, backend);
+        put(shader);
+    }
+
+    void includeTexture(Backend *backend, Image *image)
+    {
+        header(Op::Texture, backend);
+        put(image);
+    }
+
+    void includeMat4(Backend *backend, UniformId location, const glm::mat4 &mat)
+    {
+        header(Op::Mat4, backend, location);
+        put(mat);
+    }
+
+    void includeFloat(Backend *backend, UniformId location, float f)
+    {
+        header(Op::Float, backend, location);
+        put(f);
+    }
+
+    void includeTripleFloat(Backend *backend, UniformId location, float f1, float f2, float f3)
+    {
+        header(Op::TripleFloat, backend, location);
+        put(glm::vec3(f1, f2, f3));
+    }
+
+    void includeInt(Backend *backend, UniformId location, int i)
+    {
+        header(Op::Int, backend, location);
+        put(i);
+    }
+
+    void includeBool(Backend *backend, UniformId location, bool b)
+    {
+        header(Op::Bool, backend, location);
+        put(b);
+    }
+
+    void finalizeShaders(Backend *backend)
+    {
+        header(Op::Draw, backend);
+    }
+
+    // the instances aren't copied, they have to stay put until replay
+    void drawInstanced(Backend *backend, const std::vector<InstanceData> *instances)
+    {
+        header(Op::DrawInstanced, backend);
+        put(instances);
+    }
+
+    void beginPass(HelperFunctions *renderer, bool transparent)
+    {
+        header(Op::Pass, renderer, transparent ? 1 : 0);
+    }
+
+    // does every command in order, this is the only part that has to be on the gl thread
+    void replay() const
+    {
+        size_t at = 0;
+        while (at < data.size())
+        {
+            Header h;
+            get(at, h);
+            Backend *backend = static_cast<Backend *>(h.target);
+            switch (h.op)
+            {
+            case Op::Shader:
+            {
+                Shader *shader;
+                get(at, shader);
+                backend->includeShader(shader);
+                break;
+            }
+            case Op::Texture:
+            {
+                Image *image;
+                get(at, image);
+                backend->includeTexture(image);
+                break;
+            }
+            case Op::Mat4:
+            {
+                glm::mat4 mat;
+                get(at, mat);
+                backend->includeMat4(h.location, mat);
+                break;
+            }
+            case Op::Float:
+            {
+                float f;
+                get(at, f);
+                backend->includeFloat(h.location, f);
+                break;
+            }
+            case Op::TripleFloat:
+            {
+                glm::vec3 v;
+                get(at, v);
+                backend->includeTripleFloat(h.location, v.x, v.y, v.z);
+                break;
+            }
+            case Op::Int:
+            {
+                int i;
+                get(at, i);
+                backend->includeInt(h.location, i);
+                break;
+            }
+            case Op::Bool:
+            {
+                bool b;
+                get(at, b);
+                backend->includeBool(h.location, b);
+                break;
+            }
+            case Op::Draw:
+                backend->finalizeShaders();
+                break;
+            case Op::DrawInstanced:
+            {
+                const std::vector<InstanceData> *instances;
+                get(at, instances);
+                backend->drawInstanced(*instances);
+                break;
+            }
+            case Op::Pass:
+                static_cast<HelperFunctions *>(h.target)->beginPass(h.location != 0);
+                break;
+            }
+        }
+    }
+
+    void clear()
+    {
+        data.clear();
+    }
+
+    // bytes recorded
+    size_t size() const
+    {
+        return data.size();
+    }
+
+private:
+    enum class Op : uint8_t
+    {
+        Shader,
+        Texture,
+        Mat4,
+        Float,
+        TripleFloat,
+        Int,
+        Bool,
+        Draw,
+        DrawInstanced,
+        Pass,
+    };
+
+    struct Header
+    {
+        Op op;
+        UniformId location; // the uniform, or for Pass whether it's the transparent one
+        void *target;       // the backend, or the renderer for Pass
+    };
+
+    std::vector<uint8_t> data;
+
+    void header(Op op, void *target, UniformId location = 0)
+    {
+        put(Header{op, location, target});
+    }
+
+    // memcpy in and out since nothing in here is lined up
+    template <typename T>
+    void put(const T &value)
+    {
+        size_t at = data.size();
+        data.resize(at + sizeof(T));
+        std::memcpy(data.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void get(size_t &at, T &value) const
+    {
+        std::memcpy(&value, data.data() + at, sizeof(T));
+        at += sizeof(T);
+    }
+};
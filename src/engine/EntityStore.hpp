@@ -0,0 +1,327 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "customMath/BigVec.hpp"
+#include "customMath/BigVec3Array.hpp"
+#include "Backend.hpp"
+#include "MeshRegistry.hpp"
+#include "Light.hpp"
+#include "Camera.hpp"
+#include "SceneGraph.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+using Entity = uint32_t;
+constexpr Entity NO_ENTITY = UINT32_MAX;
+
+// what the scene graph caches about where something is, the world position itself is in EntityStore's position column
+struct TransformComponent
+{
+    BigVec3 localPosition; // from the parent, in its rotated frame
+    glm::vec3 rotation = glm::vec3(0.0f);
+    BigVec3 scale;
+
+    Entity parent = NO_ENTITY;
+    Camera *camera = nullptr;
+    int localSlot = -1; // where the camera keeps the camera local position
+    int sceneNode = -1;
+
+    // the state before the last step so drawing can blend, and the world rotation and rotation * scale the scene graph worked out
+    glm::vec3 lastMove = glm::vec3(0.0f);
+    glm::dmat3 previousWorldRotation = glm::dmat3(1.0);
+    glm::dmat3 worldRotation = glm::dmat3(1.0);
+    glm::mat4 modelBasis = glm::mat4(1.0f);
+    bool rotatedThisStep = false;
+};
+
+// the velocity is in EntityStore's velocity column next to the positions
+struct MotionComponent
+{
+    // metres a second squared in doubles, a Bigint only goes down to 2^-20 so a planet's pull from far out would round to nothing
+    glm::dvec3 acceleration = glm::dvec3(0.0);
+    glm::dvec3 velocityCarry = glm::dvec3(0.0); // the bit of acceleration * step the velocity was too coarse to take, see integrate
+    glm::vec3 spin = glm::vec3(-1.0f); // radians a second on each axis, everything spins by default like it always has
+    double mass = 0.0;                 // kilograms, see GravitySolver
+};
+
+struct RenderComponent
+{
+    Backend *backend = nullptr;
+    Shader *shader = nullptr;
+    Image *image = nullptr;
+    MeshHandle mesh;
+    float near = 0.1f;
+    float far = 10000.0f;
+    bool transparent = false;
+};
+
+// every object's data split up by what it's for, packed so row 0 to size() - 1 are all live with no gaps
+// positions and velocities are BigVec3Array columns so integrate is one addScaled over all of them, the rest are plain arrays in the same row order
+// rowOf goes from entity to row, destroying swaps the last row into the hole so entities move rows but their ids stay put
+// only the entities that glow get a light, those are packed the same way in their own arrays
+// references from transform(), motion(), render() and light() are only good until the next create or destroy
+class EntityStore
+{
+public:
+    Entity create()
+    {
+        Entity entity;
+        if (!freeEntities.empty())
+        {
+            entity = freeEntities.back();
+            freeEntities.pop_back();
+        }
+        else
+        {
+            entity = static_cast<Entity>(rowOf.size());
+            rowOf.push_back(NO_ROW);
+            lightOf.push_back(NO_ROW);
+        }
+        rowOf[entity] = static_cast<uint32_t>(rowEntities.size());
+        rowEntities.push_back(entity);
+        positions.push(BigVec3());
+        velocities.push(BigVec3());
+        transforms.emplace_back();
+        motions.emplace_back();
+        renders.emplace_back();
+        return entity;
+    }
+
+    void destroy(Entity entity)
+    {
+        removeLight(entity);
+
+        uint32_t row = rowOf[entity];
+        uint32_t last = static_cast<uint32_t>(rowEntities.size()) - 1;
+        positions.swapRemove(row);
+        velocities.swapRemove(row);
+        if (row != last)
+        {
+            transforms[row] = std::move(transforms[last]);
+            motions[row] = std::move(motions[last]);
+            renders[row] = std::move(renders[last]);
+            rowEntities[row] = rowEntities[last];
+            rowOf[rowEntities[row]] = row;
+            // the camera reads positions by row, so it has to follow the one that moved
+            if (transforms[row].camera != nullptr)
+                transforms[row].camera->retrackPosition(transforms[row].localSlot, row);
+        }
+        transforms.pop_back();
+        motions.pop_back();
+        renders.pop_back();
+        rowEntities.pop_back();
+
+        rowOf[entity] = NO_ROW;
+        freeEntities.push_back(entity);
+    }
+
+    bool isAlive(Entity entity) const { return entity < rowOf.size() && rowOf[entity] != NO_ROW; }
+    size_t size() const { return rowEntities.size(); }
+    size_t row(Entity entity) const { return rowOf[entity]; }
+
+    TransformComponent &transform(Entity entity) { return transforms[rowOf[entity]]; }
+    const TransformComponent &transform(Entity entity) const { return transforms[rowOf[entity]]; }
+    MotionComponent &motion(Entity entity) { return motions[rowOf[entity]]; }
+    const MotionComponent &motion(Entity entity) const { return motions[rowOf[entity]]; }
+    RenderComponent &render(Entity entity) { return renders[rowOf[entity]]; }
+    const RenderComponent &render(Entity entity) const { return renders[rowOf[entity]]; }
+
+    BigVec3 position(Entity entity) const { return positions.get(rowOf[entity]); }
+    void setPosition(Entity entity, const BigVec3 &position) { positions.set(rowOf[entity], position); }
+    BigVec3 velocity(Entity entity) const { return velocities.get(rowOf[entity]); }
+    void setVelocity(Entity entity, const BigVec3 &velocity) { velocities.set(rowOf[entity], velocity); }
+
+    // every position by row, what the camera reads from
+    const BigVec3Array &getPositions() const { return positions; }
+
+    // gives the entity a light, or back the one it already has
+    Light &addLight(Entity entity)
+    {
+        if (lightOf[entity] == NO_ROW)
+        {
+            lightOf[entity] = static_cast<uint32_t>(lights.size());
+            lights.emplace_back();
+            lightEntities.push_back(entity);
+        }
+        return lights[lightOf[entity]];
+    }
+
+    void removeLight(Entity entity)
+    {
+        uint32_t index = lightOf[entity];
+        if (index == NO_ROW)
+            return;
+        lights[index] = lights.back();
+        lightEntities[index] = lightEntities.back();
+        lightOf[lightEntities[index]] = index;
+        lights.pop_back();
+        lightEntities.pop_back();
+        lightOf[entity] = NO_ROW;
+    }
+
+    // nullptr if it doesn't glow
+    Light *light(Entity entity) { return lightOf[entity] == NO_ROW ? nullptr : &lights[lightOf[entity]]; }
+    const Light *light(Entity entity) const { return lightOf[entity] == NO_ROW ? nullptr : &lights[lightOf[entity]]; }
+
+    // copies the glowing entities' positions into their lights and lists them, once a frame before LightSelector::build
+    void gatherLights(std::vector<Light *> &out)
+    {
+        out.clear();
+        for (size_t i = 0; i < lights.size(); i++)
+        {
+            lights[i].position = positions.get(rowOf[lightEntities[i]]);
+            out.push_back(&lights[i]);
+        }
+    }
+
+    // one fixed step of movement for one entity, what RenderObject::Update does
+    // the columns are shared so only one of these can run at a time
+    void integrate(Entity entity, float deltaTime, SceneGraph &scene)
+    {
+        size_t row = rowOf[entity];
+        TransformComponent &transform = transforms[row];
+        BigVec3 velocity = velocities.get(row);
+        BigVec3 change;
+        uint8_t flags = beginStep(row, !velocity.isZero(), deltaTime, scene, change);
+
+        if (!velocity.isZero())
+        {
+            BigVec3 move = velocity * deltaTime;
+            if (flags & CHILD_MOVED)
+                transform.localPosition += move;
+            else
+            {
+                transform.lastMove = move.toFloatVec3();
+                positions.set(row, positions.get(row) + move);
+            }
+        }
+        if (flags & ACCELERATED)
+            velocities.set(row, velocity + change);
+    }
+
+    // the same for every entity: the bookkeeping goes over the job system in runs of rows,
+    // then every position moves at once with positions.addScaled(velocities) and the few rows that need more get fixed up after
+    void integrate(float deltaTime, SceneGraph &scene, JobSystem &jobs)
+    {
+        size_t count = size();
+        velocityFloats.resize(count);
+        velocityChanges.resize(count);
+        stepFlags.resize(count);
+        velocities.toFloat(velocityFloats.data());
+
+        jobs.parallelFor(count, MIN_ROWS_PER_JOB, [&](size_t begin, size_t end)
+                         {
+                             PROFILE_ZONE("Update");
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 bool moving = velocityFloats[i] != glm::vec3(0.0f);
+                                 stepFlags[i] = beginStep(i, moving, deltaTime, scene, velocityChanges[i]);
+                                 // from the float velocity, it can be off from the real move by less than the 2^-20 a position steps in
+                                 if (moving && !(stepFlags[i] & CHILD_MOVED))
+                                     transforms[i].lastMove = velocityFloats[i] * deltaTime;
+                             } });
+
+        {
+            PROFILE_ZONE("Update positions");
+            // the axes don't share anything so they can go at once, one axis can't be split since the kernels use the column's scratch
+            BigFixedColumn<Bigint> *axes[3][2] = {{&positions.x, &velocities.x}, {&positions.y, &velocities.y}, {&positions.z, &velocities.z}};
+            jobs.parallelFor(3, 1, [&](size_t begin, size_t end)
+                             {
+                                 for (size_t axis = begin; axis < end; axis++)
+                                     axes[axis][0]->addScaled(*axes[axis][1], deltaTime);
+                             });
+        }
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (stepFlags[i] == 0)
+                continue;
+            if (stepFlags[i] & CHILD_MOVED)
+            {
+                // children move around in their parent's frame, so the move comes back off the world position (exactly, it's the same
+                // rounding) and goes on the local one, the scene graph works out the world position after
+                BigVec3 move = velocities.get(i) * deltaTime;
+                positions.set(i, positions.get(i) - move);
+                transforms[i].localPosition += move;
+            }
+            if (stepFlags[i] & ACCELERATED)
+                velocities.set(i, velocities.get(i) + velocityChanges[i]);
+        }
+    }
+
+    // calls fn(entity, transform, motion, render) for every entity in row order
+    template <typename Fn>
+    void forEach(Fn &&fn)
+    {
+        for (size_t i = 0; i < rowEntities.size(); i++)
+            fn(rowEntities[i], transforms[i], motions[i], renders[i]);
+    }
+
+private:
+    static constexpr uint32_t NO_ROW = UINT32_MAX;
+    static constexpr size_t MIN_ROWS_PER_JOB = 256;
+
+    // what beginStep leaves for after the positions move
+    static constexpr uint8_t CHILD_MOVED = 1; // has a parent and a velocity, the move goes on localPosition instead
+    static constexpr uint8_t ACCELERATED = 2; // change gets added to the velocity
+
+    // everything in a step apart from moving the position, it only touches this row's components so rows can go at once
+    uint8_t beginStep(size_t row, bool moving, float deltaTime, SceneGraph &scene, BigVec3 &change)
+    {
+        TransformComponent &transform = transforms[row];
+        MotionComponent &motion = motions[row];
+        uint8_t flags = 0;
+
+        // what drawing blends from, see RenderObject::interpolation
+        transform.previousWorldRotation = transform.worldRotation;
+        transform.rotatedThisStep = false;
+        transform.lastMove = glm::vec3(0.0f);
+
+        if (moving)
+        {
+            // a child's world position gets worked out by the scene graph
+            if (transform.parent != NO_ENTITY)
+                flags |= CHILD_MOVED;
+            else
+                transform.camera->markMoved(transform.localSlot);
+            scene.markDirty(transform.sceneNode);
+        }
+        if (motion.acceleration != glm::dvec3(0.0))
+        {
+            // the velocity can only change in steps of 2^-20 m/s, so whatever's left under that gets carried to the next step
+            // instead of dropped, that way even 1e-9 m/s^2 adds up right over time, it's just applied a step of 2^-20 at a time
+            glm::dvec3 step = motion.acceleration * static_cast<double>(deltaTime) + motion.velocityCarry;
+            change = BigVec3(Bigint(step.x), Bigint(step.y), Bigint(step.z));
+            motion.velocityCarry = step - change.toDoubleVec3();
+            flags |= ACCELERATED;
+        }
+
+        if (motion.spin != glm::vec3(0.0f))
+        {
+            transform.rotation += motion.spin * deltaTime;
+            scene.markDirty(transform.sceneNode);
+        }
+        return flags;
+    }
+
+    std::vector<uint32_t> rowOf; // by entity, NO_ROW when it's not alive
+    std::vector<Entity> rowEntities;
+    std::vector<Entity> freeEntities;
+
+    BigVec3Array positions; // always the world position
+    BigVec3Array velocities;
+    std::vector<TransformComponent> transforms;
+    std::vector<MotionComponent> motions;
+    std::vector<RenderComponent> renders;
+
+    std::vector<uint32_t> lightOf; // by entity, NO_ROW when it doesn't glow
+    std::vector<Light> lights;
+    std::vector<Entity> lightEntities;
+
+    // integrate's scratch, one per row
+    std::vector<glm::vec3> velocityFloats;
+    std::vector<BigVec3> velocityChanges;
+    std::vector<uint8_t> stepFlags;
+};
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <glm/glm.hpp>
+
+// has to match MAX_LIGHTS in the shaders
+constexpr int MAX_FRAME_LIGHTS = 127;
+
+// how many lights one object gets, has to match MAX_OBJECT_LIGHTS in the near shaders
+constexpr int MAX_OBJECT_LIGHTS = 8;
+
+// which uniform buffer binding the FrameData block lives on
+constexpr unsigned FRAME_DATA_BINDING = 0;
+
+// one light as the shaders see it
+struct FrameLight
+{
+    glm::vec4 position;       // xyz is camera local, w isn't used
+    glm::vec4 colorIntensity; // rgb is the color, a is the intensity
+};
+
+// everything that's the same for every object in a frame, uploaded once a frame into the FrameData uniform block
+// the layout follows std140 (everything is a vec4 or mat4) so it can get copied in as is
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection; // the depth part gets replaced per object by uDepth since near and far are per object
+    glm::vec4 settings;   // x = gamma, y = full bright (0 or 1), z = number of lights
+    glm::vec4 ambient;    // rgb is the lights that didn't fit in lights, squashed together
+    FrameLight lights[MAX_FRAME_LIGHTS];
+
+    int lightCount() const
+    {
+        return static_cast<int>(settings.z);
+    }
+
+    // how much of the struct actually needs uploading, the unused lights at the end don't
+    size_t usedSize() const
+    {
+        return offsetof(FrameData, lights) + lightCount() * sizeof(FrameLight);
+    }
+};
+
+static_assert(sizeof(FrameLight) == 32, "FrameLight has to match the std140 layout");
+static_assert(offsetof(FrameData, lights) == 160, "FrameData has to match the std140 layout");
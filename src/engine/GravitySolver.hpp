@@ -0,0 +1,323 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "JobSystem.hpp"
+#include "RenderObject.h"
+#include "Profiler.hpp"
+
+// n body gravity with a barnes hut octree, so it's about n log n instead of every pair
+// everything with a mass above zero pulls on everything else with a mass, and its acceleration gets replaced each solve
+// the positions get subtracted from the corner of the bounding box as Bigints first, so the doubles the tree runs on
+// are exact offsets even if the whole system is a googol meters from the origin
+// the accelerations stay doubles, the velocity only moves in 2^-20 m/s steps but integrate carries what's under that over,
+// so a far out planet's pull still adds up right, the velocity is just never more than 2^-20 m/s off
+class GravitySolver
+{
+public:
+    double theta = 0.5;             // opening angle, a cell gets treated as one body when its size / distance is below this
+    double gravitationalConstant = 6.674e-11;
+    double softening = 1.0;         // meters, stops two bodies right on top of each other from flinging off to infinity
+    size_t minBodiesPerJob = 64;
+
+    // run once per step before Update
+    void solve(const std::vector<RenderObject *> &objects, JobSystem &jobs)
+    {
+        PROFILE_ZONE("gravity");
+        bodies.clear();
+        for (RenderObject *object : objects)
+        {
+            if (object->getMass() > 0.0)
+                bodies.push_back({object});
+        }
+        nodes.clear();
+        if (bodies.size() < 2)
+        {
+            for (Body &body : bodies)
+                body.object->setAcceleration(glm::dvec3(0.0));
+            return;
+        }
+
+        // the corner everything gets measured from, still in Bigint
+        origin = bodies[0].object->getPosition();
+        for (const Body &body : bodies)
+        {
+            BigVec3 p = body.object->getPosition();
+            if (p.x < origin.x)
+                origin.x = p.x;
+            if (p.y < origin.y)
+                origin.y = p.y;
+            if (p.z < origin.z)
+                origin.z = p.z;
+        }
+
+        // the Bigint subtracts are the slow part so they go wide
+        jobs.parallelFor(bodies.size(), minBodiesPerJob, [this](size_t begin, size_t end)
+                         {
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 bodies[i].offset = (bodies[i].object->getPosition() - origin).toDoubleVec3();
+                                 bodies[i].mass = bodies[i].object->getMass();
+                             } });
+
+        double size = 0.0;
+        for (const Body &body : bodies)
+            size = std::max({size, body.offset.x, body.offset.y, body.offset.z});
+        size = std::max(size, 1.0) * (1.0 + 1e-9); // a bit bigger so nothing sits right on the far edge
+        double half = size * 0.5;
+
+        jobs.parallelFor(bodies.size(), minBodiesPerJob, [this, size](size_t begin, size_t end)
+                         {
+                             for (size_t i = begin; i < end; i++)
+                                 bodies[i].key = mortonKey(bodies[i].offset / size);
+                         });
+        std::sort(bodies.begin(), bodies.end(), [](const Body &a, const Body &b)
+                  { return a.key < b.key; });
+
+        buildTree(jobs, glm::dvec3(half), half);
+
+        std::atomic<uint64_t> pulls{0};
+        jobs.parallelFor(bodies.size(), minBodiesPerJob, [&](size_t begin, size_t end)
+                         {
+                             uint64_t count = 0;
+                             for (size_t i = begin; i < end; i++)
+                             {
+                                 bodies[i].object->setAcceleration(accelerationAt(i, count) * gravitationalConstant);
+                             }
+                             pulls += count; });
+        interactions = pulls;
+    }
+
+    // how big the last tree was and how many cell or body pulls the last solve added up, for checking theta
+    size_t getNodeCount() const { return nodes.size(); }
+    uint64_t getInteractions() const { return interactions; }
+
+private:
+    static constexpr int LEVELS = 21;        // bits per axis in the morton key
+    static constexpr size_t LEAF_SIZE = 8;   // cells with this many bodies or fewer just get added up directly
+
+    struct Body
+    {
+        RenderObject *object;
+        glm::dvec3 offset = glm::dvec3(0.0); // from origin
+        double mass = 0.0;
+        uint64_t key = 0;
+    };
+
+    struct Node
+    {
+        glm::dvec3 center;
+        double half;
+        glm::dvec3 massCenter = glm::dvec3(0.0);
+        double mass = 0.0;
+        uint32_t begin, end;         // bodies in here, they're next to each other since they're sorted by key
+        int children[8] = {-1, -1, -1, -1, -1, -1, -1, -1};
+        bool leaf = false;
+    };
+
+    std::vector<Body> bodies;
+    std::vector<Node> nodes;
+    std::vector<std::vector<Node>> subtrees; // one per top level octant while building
+    BigVec3 origin;
+    uint64_t interactions = 0;
+
+    // spreads the low 21 bits out to every third bit
+    static uint64_t spreadBits(uint64_t v)
+    {
+        v &= 0x1FFFFF;
+        v = (v | v << 32) & 0x1F00000000FFFFull;
+        v = (v | v << 16) & 0x1F0000FF0000FFull;
+        v = (v | v << 8) & 0x100F00F00F00F00Full;
+        v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    }
+
+    // position has to be in [0, 1)
+    static uint64_t mortonKey(const glm::dvec3 &position)
+    {
+        const double cells = static_cast<double>(1u << LEVELS);
+        auto cell = [&](double v)
+        {
+            return static_cast<uint64_t>(std::min(std::max(v * cells, 0.0), cells - 1.0));
+        };
+        return spreadBits(cell(position.x)) | spreadBits(cell(position.y)) << 1 | spreadBits(cell(position.z)) << 2;
+    }
+
+    // which of a node's 8 children a key is in at depth (the root's children are depth 0)
+    static int octant(uint64_t key, int depth)
+    {
+        return static_cast<int>((key >> (3 * (LEVELS - 1 - depth))) & 7);
+    }
+
+    // the root's 8 octants get built on their own at the same time and then glued on after the root
+    void buildTree(JobSystem &jobs, const glm::dvec3 &center, double half)
+    {
+        Node root;
+        root.center = center;
+        root.half = half;
+        root.begin = 0;
+        root.end = static_cast<uint32_t>(bodies.size());
+        nodes.push_back(root);
+
+        uint32_t ranges[9];
+        splitRange(0, root.end, 0, ranges);
+
+        subtrees.resize(8);
+        jobs.parallelFor(8, 1, [&](size_t begin, size_t end)
+                         {
+                             for (size_t c = begin; c < end; c++)
+                             {
+                                 subtrees[c].clear();
+                                 if (ranges[c] < ranges[c + 1])
+                                     build(subtrees[c], ranges[c], ranges[c + 1], childCenter(center, half, static_cast<int>(c)), half * 0.5, 1);
+                             } });
+
+        for (int c = 0; c < 8; c++)
+        {
+            if (subtrees[c].empty())
+                continue;
+            int offset = static_cast<int>(nodes.size());
+            for (Node &node : subtrees[c])
+            {
+                for (int &child : node.children)
+                {
+                    if (child >= 0)
+                        child += offset;
+                }
+                nodes.push_back(node);
+            }
+            nodes[0].children[c] = offset;
+            addMass(nodes[0], nodes[offset]);
+        }
+        finishMass(nodes[0]);
+    }
+
+    // ranges[c] to ranges[c + 1] is the bodies in child c
+    void splitRange(uint32_t begin, uint32_t end, int depth, uint32_t *ranges) const
+    {
+        ranges[0] = begin;
+        for (int c = 0; c < 8; c++)
+        {
+            ranges[c + 1] = static_cast<uint32_t>(std::partition_point(bodies.begin() + ranges[c], bodies.begin() + end, [&](const Body &b)
+                                                                       { return octant(b.key, depth) <= c; }) -
+                                                  bodies.begin());
+        }
+    }
+
+    static glm::dvec3 childCenter(const glm::dvec3 &center, double half, int c)
+    {
+        double quarter = half * 0.5;
+        return center + glm::dvec3(c & 1 ? quarter : -quarter, c & 2 ? quarter : -quarter, c & 4 ? quarter : -quarter);
+    }
+
+    static void addMass(Node &node, const Node &child)
+    {
+        node.mass += child.mass;
+        node.massCenter += child.massCenter * child.mass;
+    }
+
+    static void finishMass(Node &node)
+    {
+        if (node.mass > 0.0)
+            node.massCenter /= node.mass;
+        else
+            node.massCenter = node.center;
+    }
+
+    // builds the node for bodies [begin, end) into list and gives back its index there
+    int build(std::vector<Node> &list, uint32_t begin, uint32_t end, const glm::dvec3 &center, double half, int depth)
+    {
+        int index = static_cast<int>(list.size());
+        list.emplace_back();
+        list[index].center = center;
+        list[index].half = half;
+        list[index].begin = begin;
+        list[index].end = end;
+
+        if (end - begin <= LEAF_SIZE || depth == LEVELS)
+        {
+            Node &leaf = list[index];
+            leaf.leaf = true;
+            for (uint32_t i = begin; i < end; i++)
+            {
+                leaf.mass += bodies[i].mass;
+                leaf.massCenter += bodies[i].offset * bodies[i].mass;
+            }
+            finishMass(leaf);
+            return index;
+        }
+
+        uint32_t ranges[9];
+        splitRange(begin, end, depth, ranges);
+        for (int c = 0; c < 8; c++)
+        {
+            if (ranges[c] == ranges[c + 1])
+                continue;
+            // list can reallocate in here so no holding on to references across it
+            int child = build(list, ranges[c], ranges[c + 1], childCenter(center, half, c), half * 0.5, depth + 1);
+            list[index].children[c] = child;
+            addMass(list[index], list[child]);
+        }
+        finishMass(list[index]);
+        return index;
+    }
+
+    // the pull on body i from everything else, still needs multiplying by G
+    glm::dvec3 accelerationAt(size_t i, uint64_t &count) const
+    {
+        const glm::dvec3 &p = bodies[i].offset;
+        double soft2 = softening * softening;
+        double theta2 = theta * theta;
+        glm::dvec3 a(0.0);
+
+        auto pull = [&](const glm::dvec3 &from, double mass)
+        {
+            glm::dvec3 d = from - p;
+            double r2 = glm::dot(d, d) + soft2;
+            a += d * (mass / (r2 * std::sqrt(r2)));
+            count++;
+        };
+
+        int stack[8 * LEVELS + 8];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0)
+        {
+            const Node &node = nodes[stack[--top]];
+            if (node.mass <= 0.0)
+                continue;
+
+            glm::dvec3 d = node.massCenter - p;
+            double distance2 = glm::dot(d, d);
+            bool inside = i >= node.begin && i < node.end;
+            double size = node.half * 2.0;
+            if (!inside && size * size < theta2 * distance2)
+            {
+                pull(node.massCenter, node.mass);
+                continue;
+            }
+
+            if (node.leaf)
+            {
+                for (uint32_t j = node.begin; j < node.end; j++)
+                {
+                    if (j != i)
+                        pull(bodies[j].offset, bodies[j].mass);
+                }
+                continue;
+            }
+
+            for (int child : node.children)
+            {
+                if (child >= 0)
+                    stack[top++] = child;
+            }
+        }
+        return a;
+    }
+};
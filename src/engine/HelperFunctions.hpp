@@ -6,6 +6,9 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include "Uniforms.hpp"
+#include "FrameData.hpp"
 
 class HelperFunctions
 {
@@ -14,6 +17,12 @@ public:
 
     virtual void swapBuffer() = 0;
 
+    // sends the per frame camera and light data to every shader at once, do it once a frame before drawing
+    virtual void uploadFrameData(const FrameData &data) = 0;
+
+    // opaque passes draw with blending off and write depth, transparent ones blend and leave the depth alone
+    virtual void beginPass(bool transparent) = 0;
+
     virtual ~HelperFunctions() = default;
 
 protected:
@@ -28,11 +37,29 @@ public:
     virtual unsigned int getID() const = 0;
 };
 
+// one mesh on the gpu, made by Backend::createMeshBuffer and shared between every object using that mesh through MeshRegistry
+class MeshBuffer
+{
+public:
+    virtual ~MeshBuffer() = default;
+
+    // it gets the id
+    virtual unsigned int getID() const = 0;
+
+    virtual int getVertexCount() const = 0;
+
+    // swaps in new vertices, this changes it for every object sharing the mesh
+    virtual void update(const std::vector<float> &verts) = 0;
+};
+
 class Shader
 {
 public:
     virtual unsigned int getShader() const = 0;
 
+    // where the uniform is in this program, -1 if the program doesn't have it
+    virtual int getUniformLocation(UniformId id) const = 0;
+
     // deletes the thing
     virtual ~Shader() = default;
 };
\ No newline at end of file
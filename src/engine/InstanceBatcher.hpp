@@ -0,0 +1,126 @@
+#pragma once
+
+#include <map>
+#include <cfloat>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+#include <unordered_map>
+#include "RenderObject.h"
+#include "Profiler.hpp"
+
+// draws everything that shares a mesh, shader and image with one instanced call instead of one call each
+// shaders only get batched once they have an instanced version registered with addVariant,
+// anything else just gets its normal Draw
+class InstanceBatcher
+{
+public:
+    // instanced gets used in place of shader for batched draws, it has to read InstanceData as attributes
+    void addVariant(Shader *shader, Shader *instanced)
+    {
+        variants[shader] = instanced;
+    }
+
+    // call where the Draw loop would go, after camera->updateLocalPositions and RenderObject::uploadFrameData
+    // the groups go into RenderObject::renderQueue like everything else, so flush that after
+    // transparent objects don't get batched since they have to be sorted one by one
+    // with jobs the instance data (matrices, light picking and so on) gets filled in over all the threads
+    void submit(const std::vector<RenderObject *> &objects, JobSystem *jobs = nullptr)
+    {
+        for (auto &group : groups)
+            group.second.members.clear();
+
+        for (RenderObject *object : objects)
+        {
+            auto variant = variants.find(object->getShader());
+            if (variant == variants.end() || object->isTransparent())
+            {
+                object->Draw();
+                continue;
+            }
+            if (!object->isVisible())
+                continue;
+
+            Group &group = groups[Key(object->getMesh().get(), variant->second, object->getImage())];
+            if (group.members.empty())
+            {
+                group.leader = object;
+                group.shader = variant->second;
+                group.image = object->getImage();
+                group.nearest = FLT_MAX;
+            }
+            group.members.push_back(object);
+            group.nearest = std::min(group.nearest, glm::length(object->getLocalPosition()));
+        }
+
+        // every instance in every group in one list so the filling can be split up evenly
+        pending.clear();
+        for (auto &entry : groups)
+        {
+            Group &group = entry.second;
+            group.instances.resize(group.members.size());
+            for (size_t i = 0; i < group.members.size(); i++)
+                pending.push_back({&group, i});
+        }
+        auto fill = [this](size_t begin, size_t end)
+        {
+            PROFILE_ZONE("fillInstances");
+            for (size_t i = begin; i < end; i++)
+                pending[i].group->members[pending[i].index]->fillInstance(pending[i].group->instances[pending[i].index]);
+        };
+        if (jobs != nullptr)
+            jobs->parallelFor(pending.size(), 64, fill);
+        else
+            fill(0, pending.size());
+
+        drawCalls = 0;
+        for (auto &entry : groups)
+        {
+            Group &group = entry.second;
+            if (group.instances.empty())
+                continue;
+            RenderObject::renderQueue.submit(RenderQueue::makeKey(false, group.shader->getShader(), group.image->getID(), group.nearest), &group);
+            drawCalls++;
+        }
+    }
+
+    // how many instanced draws the last frame submitted, handy for checking the batching is working
+    unsigned getDrawCalls() const
+    {
+        return drawCalls;
+    }
+
+private:
+    // the mesh pointer is only compared, a group whose mesh went away just sits empty
+    using Key = std::tuple<const Mesh *, Shader *, Image *>;
+
+    struct Group : Renderable
+    {
+        RenderObject *leader = nullptr;
+        Shader *shader = nullptr;
+        Image *image = nullptr;
+        float nearest = 0.0f;                // the closest instance, the group gets sorted by that
+        std::vector<RenderObject *> members;
+        std::vector<InstanceData> instances; // one per member, both kept between frames so they don't reallocate
+
+        // any object's backend in the group points at the same shared mesh, so the first one draws the whole group
+        void record(CommandBuffer &commands)
+        {
+            Backend *backend = leader->getBackend();
+            commands.includeShader(backend, shader);
+            commands.includeTexture(backend, image);
+            commands.drawInstanced(backend, &instances);
+        }
+    };
+
+    struct Pending
+    {
+        Group *group;
+        size_t index;
+    };
+
+    std::unordered_map<Shader *, Shader *> variants;
+    std::map<Key, Group> groups;
+    std::vector<Pending> pending;
+    unsigned drawCalls = 0;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "FrameData.hpp"
+
+// everything one object needs for an instanced draw, one of these per object goes in the instance buffer
+// it's the same stuff addVarsToShader sends as uniforms, the instanced shaders read it as attributes instead
+struct InstanceData
+{
+    glm::mat4 model;               // camera local
+    glm::vec4 emission;            // rgb is the color, a is the intensity at the camera
+    glm::vec4 depth;               // x and y are the projection's depth part, z is the cull radius
+    glm::vec4 ambient;             // rgb is the lights that didn't make the cut for this object
+    int lights[MAX_OBJECT_LIGHTS]; // into FrameData::lights, -1 when there's no light there
+};
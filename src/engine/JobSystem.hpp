@@ -0,0 +1,195 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+// a pool of worker threads that steal from each other, make one and share it for everything that can go wide
+// every thread has its own queue and takes from the back of it, when that's empty it takes from the front of someone else's
+// whoever calls parallelFor works on the jobs too instead of just waiting, so calling it from inside a job is fine
+class JobSystem
+{
+public:
+    using Job = std::function<void()>;
+
+    // threads counts the calling thread too, so this makes threads - 1 workers
+    explicit JobSystem(unsigned threads = std::thread::hardware_concurrency())
+    {
+        threads = std::max(1u, threads);
+        for (unsigned i = 0; i < threads; i++)
+            queues.push_back(std::make_unique<Queue>());
+        for (unsigned i = 1; i < threads; i++)
+            workers.emplace_back(&JobSystem::work, this, i);
+    }
+
+    ~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    unsigned getThreadCount() const
+    {
+        return static_cast<unsigned>(queues.size());
+    }
+
+    // runs fn(begin, end) over [0, count) in chunks of at least minChunk and waits for all of them
+    // the chunks run at the same time so fn can't touch anything another chunk touches
+    // if a chunk throws the first exception gets thrown again here once everything's done
+    void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)> &fn)
+    {
+        if (count == 0)
+            return;
+        minChunk = std::max<size_t>(1, minChunk);
+
+        // a few chunks per thread so the stealing has something to even out
+        size_t chunks = std::min((count + minChunk - 1) / minChunk, static_cast<size_t>(getThreadCount()) * CHUNKS_PER_THREAD);
+        if (chunks <= 1)
+        {
+            fn(0, count);
+            return;
+        }
+
+        std::atomic<size_t> remaining(chunks);
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        unsigned self = threadIndex();
+        for (size_t c = 0; c < chunks; c++)
+        {
+            size_t begin = c * chunkSize;
+            size_t end = std::min(count, begin + chunkSize);
+            push((self + c) % queues.size(), [&, begin, end]
+                 {
+                     try
+                     {
+                         if (begin < end)
+                             fn(begin, end);
+                     }
+                     catch (...)
+                     {
+                         std::lock_guard<std::mutex> lock(errorMutex);
+                         if (!error)
+                             error = std::current_exception();
+                     }
+                     remaining.fetch_sub(1, std::memory_order_release); });
+        }
+        // taking the lock makes sure a worker that just saw an empty queue is actually asleep before we wake it
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+        }
+        wake.notify_all();
+
+        // help out until our chunks are all done, the ones we grab might not even be ours
+        while (remaining.load(std::memory_order_acquire) != 0)
+        {
+            if (!runOne(self))
+                std::this_thread::yield();
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; // 0 is for threads that aren't workers
+    std::vector<std::thread> workers;
+    std::atomic<size_t> queued{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+
+    // which queue the current thread owns, anything that isn't one of our workers shares 0
+    // it's only where a thread looks first (every queue has its own lock), so two JobSystems sharing it is harmless
+    static unsigned &threadIndexStorage()
+    {
+        thread_local unsigned index = 0;
+        return index;
+    }
+
+    unsigned threadIndex() const
+    {
+        unsigned index = threadIndexStorage();
+        return index < queues.size() ? index : 0;
+    }
+
+    void push(size_t queue, Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+            queues[queue]->jobs.push_back(std::move(job));
+        }
+        queued.fetch_add(1, std::memory_order_release);
+    }
+
+    // does one job if it can find one, own queue first from the back then everyone else's from the front
+    bool runOne(unsigned self)
+    {
+        Job job;
+        {
+            Queue &own = *queues[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty())
+            {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+            }
+        }
+
+        for (size_t i = 1; !job && i < queues.size(); i++)
+        {
+            Queue &other = *queues[(self + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (!other.jobs.empty())
+            {
+                job = std::move(other.jobs.front());
+                other.jobs.pop_front();
+            }
+        }
+
+        if (!job)
+            return false;
+        queued.fetch_sub(1, std::memory_order_acq_rel);
+        job();
+        return true;
+    }
+
+    void work(unsigned index)
+    {
+        threadIndexStorage() = index;
+        while (true)
+        {
+            if (runOne(index))
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [&]
+                      { return stopping || queued.load(std::memory_order_acquire) != 0; });
+            if (stopping)
+                return;
+        }
+    }
+};
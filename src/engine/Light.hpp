@@ -0,0 +1,12 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include "customMath/BigVec.hpp"
+
+struct Light
+{
+    BigVec3 position; // where the glowing entity was, EntityStore::gatherLights copies it in every frame
+    glm::vec3 color = glm::vec3(0.0f);
+    Bigint intensity;
+    int frameIndex = -1; // where it ended up in this frame's FrameData, -1 if it didn't make the cut
+};
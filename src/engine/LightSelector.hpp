@@ -0,0 +1,188 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+#include <algorithm>
+#include <climits>
+#include <utility>
+#include <glm/glm.hpp>
+#include "Light.hpp"
+#include "Camera.hpp"
+#include "FrameData.hpp"
+#include "customMath/BigMath.hpp"
+
+// the lights one object actually shades with, the rest get folded into ambient
+struct LightChoice
+{
+    int count = 0;
+    int indices[MAX_OBJECT_LIGHTS]; // into FrameData::lights
+    glm::vec3 ambient = glm::vec3(0.0f);
+};
+
+// picks which lights matter for what, once a frame instead of every object looping over every light
+// build() ranks all the lights by how bright they are at the camera, the best MAX_FRAME_LIGHTS go in the frame buffer
+// and the rest become a flat ambient, then the frame lights get put in a grid by how far they reach
+// select() only looks at the lights that reach the object's cell (plus the ones that reach everywhere),
+// keeps the brightest lightsPerObject of them and folds the others into ambient
+class LightSelector
+{
+public:
+    int lightsPerObject = MAX_OBJECT_LIGHTS;
+    double cutoff = 1.0e-4;      // a light dimmer than this somewhere doesn't count there
+    double cellSize = 100.0;     // size of the grid cells in meters
+    int maxCellReach = 2;        // lights reaching more cells than this each way skip the grid and go to everyone
+    float foldedStrength = 0.35f; // about what a light averages out to over every facing, plus the 0.1 ambient
+
+    // lights further than this get pulled in to this distance with their intensity scaled to match, so the shader's floats don't overflow
+    static constexpr double MAX_LIGHT_DISTANCE = 1.0e15;
+
+    void build(const std::vector<Light *> &lights, const Camera &camera, FrameData &data)
+    {
+        ranked.clear();
+        BigVec3 offset;
+        for (Light *l : lights)
+        {
+            l->frameIndex = -1;
+
+            // same way round as Camera::convertToLocal so it lines up with FragPos
+            offset = camera.position - l->position;
+            double distance = bigMath::length(offset).toDouble();
+
+            Ranked r;
+            r.light = l;
+            if (distance <= MAX_LIGHT_DISTANCE)
+            {
+                r.position = offset.toDoubleVec3();
+                r.intensity = l->intensity.toDouble();
+            }
+            else
+            {
+                // the direction and the brightness at the camera come from the leading bits, so even a googol meters away works,
+                // then it gets put at MAX_LIGHT_DISTANCE with the intensity it would need there to look the same
+                r.position = glm::dvec3(bigMath::normalizeToFloat(offset)) * MAX_LIGHT_DISTANCE;
+                r.intensity = bigMath::inverseSquare(l->intensity, offset) * MAX_LIGHT_DISTANCE * MAX_LIGHT_DISTANCE;
+            }
+            r.intensity = std::min(r.intensity, static_cast<double>(FLT_MAX));
+            double distanceSquared = glm::dot(r.position, r.position);
+            r.atCamera = distanceSquared > 0.0 ? r.intensity / distanceSquared : r.intensity;
+            ranked.push_back(r);
+        }
+
+        // only sort when there's more than fits, the brightest ones at the camera win
+        size_t kept = ranked.size();
+        glm::vec3 frameAmbient(0.0f);
+        if (kept > static_cast<size_t>(MAX_FRAME_LIGHTS))
+        {
+            kept = MAX_FRAME_LIGHTS;
+            std::nth_element(ranked.begin(), ranked.begin() + kept, ranked.end(),
+                             [](const Ranked &a, const Ranked &b)
+                             { return a.atCamera > b.atCamera; });
+            for (size_t i = kept; i < ranked.size(); i++)
+                frameAmbient += ranked[i].light->color * static_cast<float>(ranked[i].atCamera) * foldedStrength;
+        }
+
+        cells.clear();
+        everywhere.clear();
+        for (size_t i = 0; i < kept; i++)
+        {
+            const Ranked &r = ranked[i];
+            r.light->frameIndex = static_cast<int>(i);
+            data.lights[i].position = glm::vec4(glm::vec3(r.position), 1.0f);
+            data.lights[i].colorIntensity = glm::vec4(r.light->color, static_cast<float>(r.intensity));
+
+            // how far away it's still brighter than the cutoff
+            double reach = std::sqrt(r.intensity / cutoff);
+            glm::dvec3 low = glm::floor((r.position - reach) / cellSize);
+            glm::dvec3 high = glm::floor((r.position + reach) / cellSize);
+            if (high.x - low.x > 2 * maxCellReach || high.y - low.y > 2 * maxCellReach || high.z - low.z > 2 * maxCellReach ||
+                glm::length(r.position) > cellSize * INT32_MAX / 2)
+            {
+                everywhere.push_back(static_cast<int>(i));
+                continue;
+            }
+            for (int64_t x = static_cast<int64_t>(low.x); x <= static_cast<int64_t>(high.x); x++)
+                for (int64_t y = static_cast<int64_t>(low.y); y <= static_cast<int64_t>(high.y); y++)
+                    for (int64_t z = static_cast<int64_t>(low.z); z <= static_cast<int64_t>(high.z); z++)
+                        cells.push_back({cellKey(x, y, z), static_cast<int>(i)});
+        }
+
+        // sorted by cell so select can binary search it, the vector keeps its memory so the grid doesn't get reallocated every frame
+        // two of one light's cells can hash the same, sorting puts those next to each other so unique stops it being scored twice
+        std::sort(cells.begin(), cells.end());
+        cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+        frameLights.assign(ranked.begin(), ranked.begin() + kept);
+        data.settings.z = static_cast<float>(kept);
+        data.ambient = glm::vec4(frameAmbient, 0.0f);
+    }
+
+    // localPosition is camera local like Camera::getLocalPosition gives, self is the object's own light so it doesn't light itself
+    // fine to call from lots of threads at once after build
+    void select(const glm::vec3 &localPosition, const Light *self, LightChoice &out) const
+    {
+        out.count = 0;
+        out.ambient = glm::vec3(0.0f);
+        static thread_local std::vector<Scored> scored; // one per thread so commands can be recorded in parallel
+        scored.clear();
+
+        glm::dvec3 p(localPosition);
+        auto consider = [&](int i)
+        {
+            const Ranked &r = frameLights[i];
+            if (r.light == self)
+                return;
+            glm::dvec3 d = r.position - p;
+            double distanceSquared = std::max(glm::dot(d, d), 1.0e-6);
+            scored.push_back({i, r.intensity / distanceSquared});
+        };
+
+        for (int i : everywhere)
+            consider(i);
+        // nothing in the grid is that far out anyway
+        if (glm::length(p) <= cellSize * INT32_MAX / 2)
+        {
+            glm::dvec3 cell = glm::floor(p / cellSize);
+            int64_t key = cellKey(static_cast<int64_t>(cell.x), static_cast<int64_t>(cell.y), static_cast<int64_t>(cell.z));
+            for (auto it = std::lower_bound(cells.begin(), cells.end(), std::make_pair(key, INT_MIN)); it != cells.end() && it->first == key; ++it)
+                consider(it->second);
+        }
+
+        size_t keep = std::min(scored.size(), static_cast<size_t>(std::min(lightsPerObject, MAX_OBJECT_LIGHTS)));
+        std::partial_sort(scored.begin(), scored.begin() + keep, scored.end(),
+                          [](const Scored &a, const Scored &b)
+                          { return a.score > b.score; });
+        for (size_t i = 0; i < keep; i++)
+            out.indices[i] = scored[i].index;
+        out.count = static_cast<int>(keep);
+        for (size_t i = keep; i < scored.size(); i++)
+            out.ambient += frameLights[scored[i].index].light->color * static_cast<float>(scored[i].score) * foldedStrength;
+    }
+
+private:
+    struct Ranked
+    {
+        Light *light;
+        glm::dvec3 position; // camera local
+        double intensity;
+        double atCamera;
+    };
+
+    struct Scored
+    {
+        int index;
+        double score;
+    };
+
+    // different lights colliding is fine, that just means a few extra lights get scored, build stops one light going in twice
+    static int64_t cellKey(int64_t x, int64_t y, int64_t z)
+    {
+        return (x * 73856093) ^ (y * 19349663) ^ (z * 83492791);
+    }
+
+    std::vector<Ranked> ranked;
+    std::vector<Ranked> frameLights;
+    std::vector<int> everywhere;
+    std::vector<std::pair<int64_t, int>> cells; // (cell key, frame light), sorted by key
+};
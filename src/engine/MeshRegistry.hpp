@@ -0,0 +1,77 @@
+#pragma once
+
+#include <mutex>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "Backend.hpp"
+
+// one copy of a mesh, on the cpu and the gpu, no matter how many objects use it
+struct Mesh
+{
+    std::string name;
+    std::vector<float> vertices;
+    std::unique_ptr<MeshBuffer> buffer;
+    float radius = 0.0f; // furthest any vertex gets from the middle, for culling
+};
+
+// hang on to this to keep the mesh alive, the mesh goes away when the last handle does
+using MeshHandle = std::shared_ptr<Mesh>;
+
+// hands out shared meshes by name so identical geometry only gets made and uploaded once
+class MeshRegistry
+{
+public:
+    static constexpr int FLOATS_PER_VERTEX = 8; // position, uv, normal
+
+    // the mesh called name, make only gets called (and backend only uploads) when nobody has it yet
+    static MeshHandle get(const std::string &name, const std::function<std::vector<float>()> &make, Backend *backend)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        std::weak_ptr<Mesh> &entry = meshes()[name];
+        if (MeshHandle existing = entry.lock())
+            return existing;
+
+        MeshHandle mesh = std::make_shared<Mesh>();
+        mesh->name = name;
+        mesh->vertices = make();
+        for (size_t i = 0; i + 2 < mesh->vertices.size(); i += FLOATS_PER_VERTEX)
+        {
+            glm::vec3 vertex(mesh->vertices[i], mesh->vertices[i + 1], mesh->vertices[i + 2]);
+            mesh->radius = std::max(mesh->radius, glm::length(vertex));
+        }
+        mesh->buffer.reset(backend->createMeshBuffer(mesh->vertices));
+        entry = mesh;
+        return mesh;
+    }
+
+    // how many meshes are alive right now
+    static size_t count()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        size_t alive = 0;
+        for (auto &entry : meshes())
+        {
+            if (!entry.second.expired())
+                alive++;
+        }
+        return alive;
+    }
+
+private:
+    static std::unordered_map<std::string, std::weak_ptr<Mesh>> &meshes()
+    {
+        static std::unordered_map<std::string, std::weak_ptr<Mesh>> table;
+        return table;
+    }
+
+    static std::mutex &mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+};
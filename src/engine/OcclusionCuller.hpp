@@ -0,0 +1,264 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "Camera.hpp"
+#include "RenderObject.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// software occlusion culling, all on the cpu so it works without a gpu
+// prepare() draws the few biggest things on screen into a small depth buffer, then isOccluded() checks an object's
+// bounding box against it, anything fully behind what's already there doesn't need drawing
+// the buffer holds 1 / view depth so it interpolates straight across the screen, bigger means closer, 0 means nothing there
+class OcclusionCuller
+{
+public:
+    int maxOccluders = 8;          // how many objects get drawn into the buffer each frame
+    float minOccluderSize = 0.05f; // radius / distance, stuff smaller than this on screen isn't worth drawing in
+
+    // width has to be a multiple of 4 for the simd
+    OcclusionCuller(int width = 256, int height = 128) : width((width + 3) & ~3), height(height), depth(this->width * height) {}
+
+    // run once a frame after camera.updateLocalPositions and before anything draws
+    void prepare(const Camera &camera, const std::vector<RenderObject *> &objects)
+    {
+        tested = 0;
+        culled = 0;
+        view = camera.getViewMatrix();
+        glm::mat4 projection = camera.getProjectionMatrix(0.1f, 10000.0f);
+        scaleX = projection[0][0];
+        scaleY = projection[1][1];
+        std::fill(depth.begin(), depth.end(), 0.0f);
+
+        // the biggest ones on screen make the best occluders
+        candidates.clear();
+        for (RenderObject *object : objects)
+        {
+            if (object->isTransparent() || !object->isInFrustum())
+                continue;
+            float distance = glm::length(object->getLocalPosition());
+            float size = distance > 0.0f ? object->getBoundingRadius() / distance : INFINITY;
+            if (size >= minOccluderSize)
+                candidates.push_back({object, size});
+        }
+        size_t count = std::min(candidates.size(), static_cast<size_t>(maxOccluders));
+        std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                          [](const Candidate &a, const Candidate &b)
+                          { return a.size > b.size; });
+
+        occluders.clear();
+        for (size_t i = 0; i < count; i++)
+        {
+            occluders.push_back(candidates[i].object);
+            drawOccluder(*candidates[i].object);
+        }
+    }
+
+    // true if the object's bounding box is behind the buffer everywhere it covers
+    bool isOccluded(const RenderObject *object) const
+    {
+        if (std::find(occluders.begin(), occluders.end(), object) != occluders.end())
+            return false;
+        tested++;
+
+        glm::vec3 center = glm::vec3(view * glm::vec4(object->getLocalPosition(), 1.0f));
+        float radius = object->getBoundingRadius();
+
+        // anything touching the camera plane can't be boxed on screen, just draw it
+        float nearest = -center.z - radius;
+        if (!(nearest > 0.0f))
+            return false;
+
+        // the sphere's box on screen, made from the box around the sphere so each edge is at either its nearest or its
+        // farthest depth, the nearest only gives the outer edge, for something off to the side the inner one is at the back
+        float farthest = -center.z + radius;
+        float left = toPixelX(std::min((center.x - radius) / nearest, (center.x - radius) / farthest));
+        float right = toPixelX(std::max((center.x + radius) / nearest, (center.x + radius) / farthest));
+        float bottom = toPixelY(std::min((center.y - radius) / nearest, (center.y - radius) / farthest));
+        float top = toPixelY(std::max((center.y + radius) / nearest, (center.y + radius) / farthest));
+        if (right < 0.0f || top < 0.0f || left >= width || bottom >= height)
+            return false; // the frustum test should have caught this, but don't cull what we can't check
+
+        int x0 = std::max(0, static_cast<int>(std::floor(left)));
+        int x1 = std::min(width - 1, static_cast<int>(std::floor(right)));
+        int y0 = std::max(0, static_cast<int>(std::floor(bottom)));
+        int y1 = std::min(height - 1, static_cast<int>(std::floor(top)));
+        float closest = 1.0f / nearest;
+
+        for (int y = y0; y <= y1; y++)
+        {
+            const float *row = &depth[y * width];
+            int x = x0;
+#if defined(__SSE2__)
+            __m128 object4 = _mm_set1_ps(closest);
+            for (; x + 3 <= x1; x += 4)
+            {
+                // visible if any of the 4 pixels is further away than the object
+                if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), object4)) != 0)
+                    return false;
+            }
+#endif
+            for (; x <= x1; x++)
+            {
+                if (row[x] <= closest)
+                    return false;
+            }
+        }
+
+        culled++;
+        return true;
+    }
+
+    // how many objects got checked and how many of those were hidden since the last prepare
+    unsigned getTested() const { return tested; }
+    unsigned getCulled() const { return culled; }
+    size_t getOccluderCount() const { return occluders.size(); }
+
+    float getCullRate() const
+    {
+        return tested == 0 ? 0.0f : static_cast<float>(culled) / tested;
+    }
+
+    // the buffer, one row after another from the bottom, handy for looking at what it drew
+    const std::vector<float> &getDepth() const { return depth; }
+
+private:
+    struct Candidate
+    {
+        RenderObject *object;
+        float size;
+    };
+
+    // a vertex on the buffer, w is 1 / view depth
+    struct ScreenVertex
+    {
+        float x, y, w;
+    };
+
+    int width, height;
+    std::vector<float> depth;
+    std::vector<Candidate> candidates;
+    std::vector<const RenderObject *> occluders;
+    glm::mat4 view;
+    float scaleX = 1.0f, scaleY = 1.0f;
+    mutable unsigned tested = 0;
+    mutable unsigned culled = 0;
+
+    static constexpr float MIN_DEPTH = 1.0e-3f; // triangles with a corner closer than this get skipped instead of clipped
+
+    float toPixelX(float x) const
+    {
+        return (x * scaleX * 0.5f + 0.5f) * width;
+    }
+
+    float toPixelY(float y) const
+    {
+        return (y * scaleY * 0.5f + 0.5f) * height;
+    }
+
+    void drawOccluder(const RenderObject &object)
+    {
+        glm::mat4 modelView = view * object.getModelMatrix();
+        const std::vector<float> &vertices = object.getMesh()->vertices;
+        const int stride = MeshRegistry::FLOATS_PER_VERTEX;
+
+        ScreenVertex triangle[3];
+        for (size_t i = 0; i + 3 * stride <= vertices.size(); i += 3 * stride)
+        {
+            bool skip = false;
+            for (int k = 0; k < 3; k++)
+            {
+                const float *v = &vertices[i + k * stride];
+                glm::vec4 p = modelView * glm::vec4(v[0], v[1], v[2], 1.0f);
+                float d = -p.z;
+                // skipping a triangle only ever means less gets hidden, so no clipping needed
+                if (d < MIN_DEPTH)
+                {
+                    skip = true;
+                    break;
+                }
+                triangle[k] = {toPixelX(p.x / d), toPixelY(p.y / d), 1.0f / d};
+            }
+            if (!skip)
+                drawTriangle(triangle);
+        }
+    }
+
+    // fills every pixel whose middle is inside the triangle, keeping the closest depth
+    void drawTriangle(const ScreenVertex *t)
+    {
+        float area = (t[1].x - t[0].x) * (t[2].y - t[0].y) - (t[2].x - t[0].x) * (t[1].y - t[0].y);
+        if (area == 0.0f || !std::isfinite(area))
+            return;
+
+        int x0 = std::max(0, static_cast<int>(std::floor(std::min({t[0].x, t[1].x, t[2].x}))));
+        int x1 = std::min(width - 1, static_cast<int>(std::ceil(std::max({t[0].x, t[1].x, t[2].x}))));
+        int y0 = std::max(0, static_cast<int>(std::floor(std::min({t[0].y, t[1].y, t[2].y}))));
+        int y1 = std::min(height - 1, static_cast<int>(std::ceil(std::max({t[0].y, t[1].y, t[2].y}))));
+        if (x0 > x1 || y0 > y1)
+            return;
+        x0 &= ~3; // start the simd on a multiple of 4
+
+        // edge functions, flipped for clockwise triangles so inside is always >= 0 (occluders don't care which way they face)
+        float sign = area > 0.0f ? 1.0f : -1.0f;
+        float edgeA[3], edgeB[3], edgeC[3];
+        for (int e = 0; e < 3; e++)
+        {
+            const ScreenVertex &a = t[(e + 1) % 3];
+            const ScreenVertex &b = t[(e + 2) % 3];
+            edgeA[e] = (a.y - b.y) * sign;
+            edgeB[e] = (b.x - a.x) * sign;
+            edgeC[e] = (a.x * b.y - a.y * b.x) * sign;
+        }
+
+        // w is a plane across the screen: w = dwdx * x + dwdy * y + w0
+        float invArea = 1.0f / area;
+        float dwdx = ((t[1].w - t[0].w) * (t[2].y - t[0].y) - (t[2].w - t[0].w) * (t[1].y - t[0].y)) * invArea;
+        float dwdy = ((t[2].w - t[0].w) * (t[1].x - t[0].x) - (t[1].w - t[0].w) * (t[2].x - t[0].x)) * invArea;
+        float w0 = t[0].w - dwdx * t[0].x - dwdy * t[0].y;
+
+        for (int y = y0; y <= y1; y++)
+        {
+            float py = y + 0.5f;
+            float *row = &depth[y * width];
+            int x = x0;
+#if defined(__SSE2__)
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            // x starts on a multiple of 4 and width is one too, so whole groups always fit,
+            // the pixels past x1 are past the triangle so the edge test leaves them alone
+            for (; x <= x1; x += 4)
+            {
+                __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), offsets);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for (int e = 0; e < 3; e++)
+                {
+                    __m128 value = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(edgeA[e])), _mm_set1_ps(edgeB[e] * py + edgeC[e]));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(value, zero));
+                }
+                if (_mm_movemask_ps(inside) == 0)
+                    continue;
+
+                __m128 w = _mm_add_ps(_mm_mul_ps(px, _mm_set1_ps(dwdx)), _mm_set1_ps(dwdy * py + w0));
+                __m128 old = _mm_loadu_ps(row + x);
+                __m128 closer = _mm_max_ps(old, w);
+                _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+            }
+#endif
+            for (; x <= x1; x++)
+            {
+                float px = x + 0.5f;
+                bool inside = true;
+                for (int e = 0; e < 3; e++)
+                    inside = inside && edgeA[e] * px + edgeB[e] * py + edgeC[e] >= 0.0f;
+                if (inside)
+                    row[x] = std::max(row[x], dwdx * px + dwdy * py + w0);
+            }
+        }
+    }
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cmath>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#include "RenderObject.h"
+
+// the 6 numbers that describe an ellipse around something, angles are in radians
+// the reference plane is x z with y up, so an orbit with no inclination goes around flat and prograde is anticlockwise from above
+struct OrbitalElements
+{
+    double semiMajorAxis = 1.0; // meters
+    double eccentricity = 0.0;  // 0 is a circle, it has to stay under 1
+    double inclination = 0.0;
+    double ascendingNode = 0.0;
+    double argumentOfPeriapsis = 0.0;
+    double meanAnomalyAtEpoch = 0.0;
+    double epoch = 0.0; // simulation seconds the mean anomaly is for
+};
+
+// puts a body on rails around a parent, the position comes straight from the time so it never drifts
+// and a huge time warp costs the same as no time warp
+// apply them parents first every step after Update, it also zeroes the body's velocity and acceleration so nothing else moves it
+class Orbit
+{
+public:
+    // gravitationalParameter is G times the parent's mass (plus the body's if it's big enough to matter)
+    // with no parent it goes around center instead
+    Orbit(RenderObject *body, const RenderObject *parent, double gravitationalParameter, const OrbitalElements &elements)
+        : body(body), parent(parent), mu(gravitationalParameter), elements(elements)
+    {
+        if (elements.eccentricity < 0.0 || elements.eccentricity >= 1.0)
+            throw std::runtime_error("Orbit only does ellipses, eccentricity has to be in [0, 1)");
+        if (elements.semiMajorAxis <= 0.0 || mu <= 0.0)
+            throw std::runtime_error("Orbit needs a positive semi major axis and gravitational parameter");
+
+        period = 2.0 * PI * std::sqrt(elements.semiMajorAxis * elements.semiMajorAxis * elements.semiMajorAxis / mu);
+        semiMinorAxis = elements.semiMajorAxis * std::sqrt(1.0 - elements.eccentricity * elements.eccentricity);
+
+        // the directions of periapsis (p) and 90 degrees on from it (q), worked out in the usual z up frame and then
+        // swapped to y up as (x, z, -y)
+        double cosO = std::cos(elements.ascendingNode), sinO = std::sin(elements.ascendingNode);
+        double cosW = std::cos(elements.argumentOfPeriapsis), sinW = std::sin(elements.argumentOfPeriapsis);
+        double cosI = std::cos(elements.inclination), sinI = std::sin(elements.inclination);
+        glm::dvec3 pz(cosO * cosW - sinO * sinW * cosI, sinO * cosW + cosO * sinW * cosI, sinW * sinI);
+        glm::dvec3 qz(-cosO * sinW - sinO * cosW * cosI, -sinO * sinW + cosO * cosW * cosI, cosW * sinI);
+        p = glm::dvec3(pz.x, pz.z, -pz.y);
+        q = glm::dvec3(qz.x, qz.z, -qz.y);
+    }
+
+    // eccentric anomaly from mean anomaly, halley's method so it's normally done in 2 or 3 goes even when it's very eccentric
+    static double solveKepler(double meanAnomaly, double eccentricity)
+    {
+        double m = std::remainder(meanAnomaly, 2.0 * PI); // -pi to pi
+        double e = eccentricity;
+        double guess = e < 0.8 ? m : (m < 0.0 ? -PI : PI);
+        for (int i = 0; i < 16; i++)
+        {
+            double s = e * std::sin(guess);
+            double c = e * std::cos(guess);
+            double f = guess - s - m;
+            double df = 1.0 - c;
+            double step = f / (df - 0.5 * f * s / df);
+            guess -= step;
+            if (std::abs(step) < 1e-15)
+                break;
+        }
+        return guess;
+    }
+
+    double getEccentricAnomaly(double time) const
+    {
+        // the whole orbits get taken off first so a big time doesn't eat the precision of the angle
+        double sincePeriapsis = std::fmod(time - elements.epoch, period);
+        return solveKepler(elements.meanAnomalyAtEpoch + 2.0 * PI * sincePeriapsis / period, elements.eccentricity);
+    }
+
+    // where the body is from the parent at a time
+    glm::dvec3 offsetAt(double time) const
+    {
+        double e = getEccentricAnomaly(time);
+        return p * (elements.semiMajorAxis * (std::cos(e) - elements.eccentricity)) + q * (semiMinorAxis * std::sin(e));
+    }
+
+    // meters per second relative to the parent, for letting a body off the rails with the right velocity
+    glm::dvec3 velocityAt(double time) const
+    {
+        double e = getEccentricAnomaly(time);
+        double rate = std::sqrt(mu / elements.semiMajorAxis) / (elements.semiMajorAxis * (1.0 - elements.eccentricity * std::cos(e)));
+        return p * (-elements.semiMajorAxis * std::sin(e) * rate) + q * (semiMinorAxis * std::cos(e) * rate);
+    }
+
+    BigVec3 positionAt(double time) const
+    {
+        glm::dvec3 offset = offsetAt(time);
+        return (parent ? parent->getPosition() : center) + BigVec3(Bigint(offset.x), Bigint(offset.y), Bigint(offset.z));
+    }
+
+    // moves the body to where it should be at time, the parent has to have been done already this step
+    void apply(double time)
+    {
+        body->moveTo(positionAt(time));
+        body->setVelocity(BigVec3());
+        body->setAcceleration(glm::dvec3(0.0));
+    }
+
+    double getPeriod() const { return period; }
+    const OrbitalElements &getElements() const { return elements; }
+    RenderObject *getBody() const { return body; }
+
+    BigVec3 center; // what it goes around when there's no parent
+
+private:
+    static constexpr double PI = 3.14159265358979323846;
+
+    RenderObject *body;
+    const RenderObject *parent;
+    double mu;
+    OrbitalElements elements;
+    double period;
+    double semiMinorAxis;
+    glm::dvec3 p, q;
+};
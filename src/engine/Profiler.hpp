@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <fstream>
+#include <ostream>
+#include <iomanip>
+
+// times scoped zones into a ring buffer per thread, so recording one is two clock reads and a store with no locks
+// once a frame endFrame adds up how long each zone name took that frame and keeps the last STAT_FRAMES of them for p50/p99,
+// and writeChromeTrace dumps whatever's still in the rings as a file chrome://tracing or ui.perfetto.dev can open
+// use it through PROFILE_ZONE and PROFILE_END_FRAME, they compile to nothing without ENGINE_PROFILER
+class Profiler
+{
+public:
+    static constexpr size_t RING_SIZE = 1 << 16; // events per thread before the oldest get written over
+    static constexpr size_t STAT_FRAMES = 240;   // how many frames the percentiles go back
+
+    struct Event
+    {
+        const char *name; // has to be a string literal, only the pointer gets kept
+        uint64_t start;   // nanoseconds since the profiler started
+        uint64_t end;
+    };
+
+    struct PhaseStats
+    {
+        double p50 = 0.0; // milliseconds a frame
+        double p99 = 0.0;
+        double average = 0.0;
+    };
+
+    static uint64_t now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin()).count());
+    }
+
+    static void record(const char *name, uint64_t start, uint64_t end)
+    {
+        Ring &ring = threadRing();
+        size_t at = ring.written.load(std::memory_order_relaxed);
+        ring.events[at % RING_SIZE] = Event{name, start, end};
+        ring.written.store(at + 1, std::memory_order_release);
+    }
+
+    // call on the main thread once a frame, when no jobs are running so nothing's writing to the rings
+    static void endFrame()
+    {
+        uint64_t frameEnd = now();
+        std::lock_guard<std::mutex> lock(mutex());
+        State &s = state();
+
+        // this frame's time for each zone, zones on different threads at once all add up (so it's cpu time)
+        std::unordered_map<const char *, uint64_t> totals;
+        for (auto &ring : s.rings)
+        {
+            size_t written = ring->written.load(std::memory_order_acquire);
+            size_t from = std::max(ring->read, written > RING_SIZE ? written - RING_SIZE : 0);
+            for (size_t i = from; i < written; i++)
+            {
+                const Event &e = ring->events[i % RING_SIZE];
+                totals[e.name] += e.end - e.start;
+            }
+            ring->read = written;
+        }
+
+        // two literals with the same text can have different pointers, so they get merged by name here
+        std::unordered_map<std::string, uint64_t> byName;
+        for (auto &total : totals)
+            byName[total.first] += total.second;
+        byName["frame"] = frameEnd - s.lastFrameEnd;
+        s.lastFrameEnd = frameEnd;
+
+        // every phase gets a sample every frame, not showing up counts as 0
+        for (auto &entry : byName)
+            s.phases[entry.first];
+        for (auto &phase : s.phases)
+        {
+            auto found = byName.find(phase.first);
+            double ms = found == byName.end() ? 0.0 : found->second / 1e6;
+            Phase &p = phase.second;
+            if (p.samples.size() < STAT_FRAMES)
+                p.samples.push_back(ms);
+            else
+                p.samples[p.next] = ms;
+            p.next = (p.next + 1) % STAT_FRAMES;
+        }
+        s.frames++;
+    }
+
+    static PhaseStats getStats(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto found = state().phases.find(name);
+        if (found == state().phases.end())
+            return PhaseStats();
+        return summarize(found->second.samples);
+    }
+
+    static uint64_t getFrameCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        return state().frames;
+    }
+
+    // a line per phase, slowest p99 first
+    static void printStats(std::ostream &out)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        std::vector<std::pair<std::string, PhaseStats>> rows;
+        for (auto &phase : state().phases)
+            rows.push_back({phase.first, summarize(phase.second.samples)});
+        std::sort(rows.begin(), rows.end(), [](const auto &a, const auto &b)
+                  { return a.second.p99 > b.second.p99; });
+
+        out << std::left << std::setw(20) << "phase" << std::right << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(10) << "avg ms" << "\n";
+        for (auto &row : rows)
+        {
+            out << std::left << std::setw(20) << row.first << std::right << std::fixed << std::setprecision(3)
+                << std::setw(10) << row.second.p50 << std::setw(10) << row.second.p99 << std::setw(10) << row.second.average << "\n";
+        }
+    }
+
+    // the same rule as endFrame, don't call it while jobs are running
+    static bool writeChromeTrace(const std::string &path)
+    {
+        std::ofstream out(path);
+        if (!out)
+            return false;
+
+        std::lock_guard<std::mutex> lock(mutex());
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (auto &ring : state().rings)
+        {
+            out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->id
+                << ",\"args\":{\"name\":\"" << (ring->id == 0 ? "main" : "thread " + std::to_string(ring->id)) << "\"}}";
+            first = false;
+
+            size_t written = ring->written.load(std::memory_order_acquire);
+            for (size_t i = written > RING_SIZE ? written - RING_SIZE : 0; i < written; i++)
+            {
+                const Event &e = ring->events[i % RING_SIZE];
+                out << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->id << std::fixed << std::setprecision(3)
+                    << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << (e.end - e.start) / 1000.0 << "}";
+            }
+        }
+        out << "\n]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    struct Ring
+    {
+        std::vector<Event> events = std::vector<Event>(RING_SIZE);
+        std::atomic<size_t> written{0};
+        size_t read = 0; // how far endFrame has got
+        int id = 0;      // the order threads first recorded in, the first is called main
+    };
+
+    struct Phase
+    {
+        std::vector<double> samples;
+        size_t next = 0;
+    };
+
+    struct State
+    {
+        std::vector<std::unique_ptr<Ring>> rings;
+        std::map<std::string, Phase> phases;
+        uint64_t lastFrameEnd = 0;
+        uint64_t frames = 0;
+    };
+
+    static PhaseStats summarize(std::vector<double> samples)
+    {
+        PhaseStats stats;
+        if (samples.empty())
+            return stats;
+        auto percentile = [&](double p)
+        {
+            size_t at = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+            std::nth_element(samples.begin(), samples.begin() + at, samples.end());
+            return samples[at];
+        };
+        for (double s : samples)
+            stats.average += s;
+        stats.average /= samples.size();
+        stats.p50 = percentile(0.5);
+        stats.p99 = percentile(0.99);
+        return stats;
+    }
+
+    static Ring &threadRing()
+    {
+        thread_local Ring *ring = nullptr;
+        if (ring == nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex());
+            State &s = state();
+            s.rings.push_back(std::make_unique<Ring>());
+            ring = s.rings.back().get();
+            ring->id = static_cast<int>(s.rings.size()) - 1;
+        }
+        return *ring;
+    }
+
+    static std::chrono::steady_clock::time_point origin()
+    {
+        static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        return start;
+    }
+
+    static State &state()
+    {
+        static State s;
+        return s;
+    }
+
+    static std::mutex &mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+};
+
+// times from here to the end of the scope
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char *name) : name(name), start(Profiler::now()) {}
+    ~ProfileZone() { Profiler::record(name, start, Profiler::now()); }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+
+private:
+    const char *name;
+    uint64_t start;
+};
+
+#if defined(ENGINE_PROFILER)
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_END_FRAME() Profiler::endFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
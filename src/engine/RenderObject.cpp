@@ -1,4 +1,5 @@
 #include "RenderObject.h"
+#include "OcclusionCuller.hpp"
 
 void addFace(std::vector<float> &verts,
              glm::vec3 vert0,
@@ -58,143 +59,297 @@ std::vector<float> makeTexturedCube(float size = 1.0f)
 }
 
 std::vector<Light *> RenderObject::allLights;
+FrameData RenderObject::frameData;
+LightSelector RenderObject::lightSelector;
+RenderQueue RenderObject::renderQueue;
+OcclusionCuller *RenderObject::occlusionCuller = nullptr;
 float RenderObject::gamma = 2.5f;
 bool RenderObject::disableBrightness = false;
+float RenderObject::interpolation = 1.0f;
+SceneGraph RenderObject::scene;
+EntityStore RenderObject::entities;
+
+// the same as rotating by x then y then z with glm::rotate, in doubles so children a long way from their parent land in the right place
+static glm::dmat3 eulerMatrix(const glm::vec3 &angles)
+{
+    double cx = std::cos(angles.x), sx = std::sin(angles.x);
+    double cy = std::cos(angles.y), sy = std::sin(angles.y);
+    double cz = std::cos(angles.z), sz = std::sin(angles.z);
+    glm::dmat3 x(glm::dvec3(1, 0, 0), glm::dvec3(0, cx, sx), glm::dvec3(0, -sx, cx));
+    glm::dmat3 y(glm::dvec3(cy, 0, -sy), glm::dvec3(0, 1, 0), glm::dvec3(sy, 0, cy));
+    glm::dmat3 z(glm::dvec3(cz, sz, 0), glm::dvec3(-sz, cz, 0), glm::dvec3(0, 0, 1));
+    return x * y * z;
+}
+
+// all the uniform names get turned into ids once here instead of building strings every draw
+// the camera, gamma and lights aren't in here, they go in the FrameData block once a frame
+namespace
+{
+    const UniformId U_MODEL = UniformNames::get("uModel");
+    const UniformId U_DEPTH = UniformNames::get("uDepth"); // x and y are the projection's depth part, z is the cull radius
+    const UniformId U_EMISSION_COLOR = UniformNames::get("emissionColor");
+    const UniformId U_EMISSION_INTENSITY = UniformNames::get("emissionIntensity");
+    const UniformId U_LIGHT_COUNT = UniformNames::get("uLightCount");
+    const std::vector<UniformId> U_LIGHTS = UniformNames::getArray("uLights", MAX_OBJECT_LIGHTS);
+    const UniformId U_AMBIENT = UniformNames::get("uAmbient");
+}
 
 RenderObject::RenderObject(Backend *backend, Shader *shady, Image *im, Camera *cam, glm::vec3 emissionColor, Bigint emissionIntensity, BigVec3 pos, glm::vec3 rot, glm::vec3 scl)
-    : position(pos),
-      rotation(rot), scale(scl), shader(shady), image(im), camera(cam), velocity(BigVec3(Bigint(), Bigint(), Bigint())), acceleration(BigVec3(Bigint(), Bigint(), Bigint()))
+    : entity(entities.create())
 {
-    this->backend = backend;
+    entities.setPosition(entity, pos);
+    TransformComponent &transform = this->transform();
+    transform.rotation = rot;
+    transform.scale = BigVec3(scl);
+    transform.camera = cam;
+    RenderComponent &renderData = this->renderData();
+    renderData.backend = backend;
+    renderData.shader = shady;
+    renderData.image = im;
+    renderData.mesh = MeshRegistry::get("cube", []
+                                        { return makeTexturedCube(); },
+                                        backend);
     if (emissionIntensity != 0.0f)
     {
-        thisLight = new Light{position, emissionColor, emissionIntensity};
-        allLights.push_back(thisLight);
+        Light &light = entities.addLight(entity);
+        light.color = emissionColor;
+        light.intensity = emissionIntensity;
     }
 
-    vertices = makeTexturedCube();
+    transform.localSlot = transform.camera->trackPosition(&entities.getPositions(), entities.row(entity));
+    transform.sceneNode = scene.add(this);
+    updateWorldTransform();
+    transform.previousWorldRotation = transform.worldRotation;
     setupObject();
 }
 
 RenderObject::~RenderObject()
 {
-    delete backend;
-    if (thisLight != nullptr)
+    delete renderData().backend;
+    transform().camera->untrackPosition(transform().localSlot);
+    // the children stay where they are in the world
+    for (RenderObject *child : scene.remove(transform().sceneNode))
     {
-        allLights.erase(std::find(allLights.begin(), allLights.end(), thisLight));
-        delete thisLight;
+        child->parent = nullptr;
+        child->transform().parent = NO_ENTITY;
     }
+    entities.destroy(entity);
 }
 
 void RenderObject::setupObject()
 {
-    backend->setupObject(vertices);
+    renderData().backend->setupObject(renderData().mesh->buffer.get());
 }
 
 glm::mat4 RenderObject::getModelMatrix() const
 {
-    glm::mat4 model = glm::mat4(1.0f);
-
-    // converts the position to be local to the camera
-    model = glm::translate(model, tempLocalPosition.toFloatVec3());
+    const TransformComponent &transform = this->transform();
+    glm::mat4 model = transform.modelBasis;
 
-    // rotates the model
-    model = glm::rotate(model, rotation.x, glm::vec3(1, 0, 0));
-    model = glm::rotate(model, rotation.y, glm::vec3(0, 1, 0));
-    model = glm::rotate(model, rotation.z, glm::vec3(0, 0, 1));
+    // something that turned this step gets blended from where it was, it's only a small turn so mixing the matrices is close enough
+    if (transform.rotatedThisStep && interpolation < 1.0f)
+    {
+        glm::dmat3 blended = transform.previousWorldRotation + (transform.worldRotation - transform.previousWorldRotation) * static_cast<double>(interpolation);
+        model = glm::scale(glm::mat4(glm::mat3(blended)), transform.scale.toFloatVec3());
+    }
 
-    // scales the model
-    model = glm::scale(model, scale.toFloatVec3());
+    // converts the position to be local to the camera
+    model[3] = glm::vec4(getLocalPosition(), 1.0f);
     return model;
 }
 
-// I just made the default update to rotate all around
-void RenderObject::Update(float deltaTime)
+void RenderObject::updateWorldTransform()
 {
+    TransformComponent &transform = this->transform();
+    glm::dmat3 rotationMatrix = eulerMatrix(transform.rotation);
+    if (parent != nullptr)
+    {
+        const glm::dmat3 &parentRotation = parent->transform().worldRotation;
+        rotationMatrix = parentRotation * rotationMatrix;
+        glm::dvec3 offset = parentRotation * transform.localPosition.toDoubleVec3();
+        BigVec3 world = parent->getPosition() + BigVec3(Bigint(offset.x), Bigint(offset.y), Bigint(offset.z));
+        // however it got here (its own velocity or the parent moving) it all counts as this step's move
+        transform.lastMove = (world - getPosition()).toFloatVec3();
+        entities.setPosition(entity, world);
+        transform.camera->markMoved(transform.localSlot);
+    }
+    transform.worldRotation = rotationMatrix;
+    transform.rotatedThisStep = true;
+    transform.modelBasis = glm::scale(glm::mat4(glm::mat3(transform.worldRotation)), transform.scale.toFloatVec3());
+}
 
-    if (!velocity.isZero())
+void RenderObject::updateTransforms()
+{
+    scene.update([](RenderObject *object)
+                 { object->updateWorldTransform(); });
+}
+
+void RenderObject::setParent(RenderObject *newParent)
+{
+    scene.setParent(transform().sceneNode, newParent ? newParent->transform().sceneNode : -1);
+    parent = newParent;
+    transform().parent = newParent ? newParent->entity : NO_ENTITY;
+    if (parent != nullptr)
     {
-        position += velocity * deltaTime;
+        // works out the local position that keeps it where it is now
+        transform().localPosition = offsetFromParent(getPosition());
     }
-    if (!acceleration.isZero())
+}
+
+void RenderObject::markDirty()
+{
+    scene.markDirty(transform().sceneNode);
+}
+
+// moves and spins this one object, main does all of them at once with entities.integrate
+void RenderObject::Update(float deltaTime)
+{
+    entities.integrate(entity, deltaTime, scene);
+}
+
+void RenderObject::moveTo(const BigVec3 &target)
+{
+    if (parent == nullptr)
+        transform().lastMove += (target - getPosition()).toFloatVec3();
+    setPosition(target);
+}
+
+void RenderObject::setPosition(const BigVec3 &target)
+{
+    markDirty();
+    if (parent != nullptr)
     {
-        velocity += acceleration * deltaTime;
+        // a child gets its local position changed instead and updateTransforms does the rest
+        transform().localPosition = offsetFromParent(target);
+        return;
     }
+    entities.setPosition(entity, target);
+    transform().camera->markMoved(transform().localSlot);
+}
 
-    rotation.y -= deltaTime;
-    rotation.x -= deltaTime;
-    rotation.z -= deltaTime;
+BigVec3 RenderObject::offsetFromParent(const BigVec3 &worldPosition) const
+{
+    glm::dvec3 offset = glm::transpose(parent->transform().worldRotation) * (worldPosition - parent->getPosition()).toDoubleVec3();
+    return BigVec3(Bigint(offset.x), Bigint(offset.y), Bigint(offset.z));
 }
 
 // it culls everything close and its different depending on the near value
 float RenderObject::nearCullFunction() const
 {
-    return near <= 0.1f ? 0.0f : 100.0f;
+    return renderData().near <= 0.1f ? 0.0f : 100.0f;
 }
 
-Bigint RenderObject::calculateInverseSquareLaw(const BigVec3 &subtractedPos, const Bigint &intensity) const
+float RenderObject::calculateInverseSquareLaw(const BigVec3 &subtractedPos, const Bigint &intensity)
 {
-    if (subtractedPos.x == 0 && subtractedPos.y == 0 && subtractedPos.z == 0)
-        return Bigint(1);
-    return intensity / calculateDistanceSquared(subtractedPos);
+    return bigMath::inverseSquare(intensity, subtractedPos);
 }
 
-Bigint RenderObject::calculateDistanceSquared(const BigVec3 &subtractedPos) const
+void RenderObject::uploadFrameData(const Camera &camera, HelperFunctions *renderer)
 {
-    return subtractedPos.x * subtractedPos.x +
-           subtractedPos.y * subtractedPos.y +
-           subtractedPos.z * subtractedPos.z;
+    frameData.view = camera.getViewMatrix();
+    // near and far don't matter here, every object puts its own in with uDepth
+    frameData.projection = camera.getProjectionMatrix(0.1f, 10000.0f);
+
+    frameData.settings = glm::vec4(gamma, disableBrightness ? 1.0f : 0.0f, 0.0f, 0.0f);
+    entities.gatherLights(allLights);
+    lightSelector.build(allLights, camera, frameData);
+    renderer->uploadFrameData(frameData);
 }
 
-void RenderObject::addVarsToShader()
+void RenderObject::addVarsToShader(CommandBuffer &commands)
 {
+    const RenderComponent &renderData = this->renderData();
+    const Light *light = entities.light(entity);
+    Backend *backend = renderData.backend;
     glm::mat4 matrix = getModelMatrix();
-    backend->includeMat4("uModel", matrix);
-    backend->includeMat4("uView", camera->getViewMatrix());
-    backend->includeMat4("uProjection", camera->getProjectionMatrix(near, far));
-    backend->includeFloat("u_CullRadius", nearCullFunction());
-    backend->includeFloat("gamma", gamma);
-    backend->includeBool("u_fullBright", disableBrightness);
-
-    if (thisLight != nullptr)
+    commands.includeMat4(backend, U_MODEL, matrix);
+    glm::vec2 depth = transform().camera->getDepthParameters(renderData.near, renderData.far);
+    commands.includeTripleFloat(backend, U_DEPTH, depth.x, depth.y, nearCullFunction());
+
+    if (light != nullptr)
     {
-        backend->includeTripleFloat("emissionColor", thisLight->color.x, thisLight->color.y, thisLight->color.z);
-        backend->includeFloat("emissionIntensity", calculateInverseSquareLaw(tempLocalPosition, thisLight->intensity).toFloat());
+        commands.includeTripleFloat(backend, U_EMISSION_COLOR, light->color.x, light->color.y, light->color.z);
+        commands.includeFloat(backend, U_EMISSION_INTENSITY, calculateInverseSquareLaw(tempLocalPosition, light->intensity));
     }
     else
     {
-        backend->includeTripleFloat("emissionColor", 0.0f, 0.0f, 0.0f);
-        backend->includeFloat("emissionIntensity", 0.0f);
+        commands.includeTripleFloat(backend, U_EMISSION_COLOR, 0.0f, 0.0f, 0.0f);
+        commands.includeFloat(backend, U_EMISSION_INTENSITY, 0.0f);
     }
 
-    int i = 0;
-    glm::dvec3 temp;
-    BigVec3 bigTemp;
-    for (const Light *l : allLights)
-    {
-        if (l != thisLight)
-        {
-            bigTemp = l->position - position;
-            temp = bigTemp.toDoubleVec3();
-            if (!std::isinf(temp.x) && !std::isinf(temp.y) && !std::isinf(temp.z))
-            {
-                glm::dvec3 lightPos = glm::normalize(temp);
-                backend->includeTripleFloat("lightPositions[" + std::to_string(i) + "]", lightPos.x, lightPos.y, lightPos.z);
-                backend->includeTripleFloat("lightColors[" + std::to_string(i) + "]", l->color.x, l->color.y, l->color.z);
-                backend->includeFloat("lightIntensities[" + std::to_string(i) + "]", calculateInverseSquareLaw(bigTemp, l->intensity).toFloat());
-                i++;
-            }
-        }
-    }
+    LightChoice lights;
+    lightSelector.select(getLocalPosition(), light, lights);
+    commands.includeInt(backend, U_LIGHT_COUNT, lights.count);
+    for (int i = 0; i < lights.count; i++)
+        commands.includeInt(backend, U_LIGHTS[i], lights.indices[i]);
+    commands.includeTripleFloat(backend, U_AMBIENT, lights.ambient.x, lights.ambient.y, lights.ambient.z);
+}
 
-    backend->includeInt("numLights", i);
+bool RenderObject::isVisible() const
+{
+    if (!isInFrustum())
+        return false;
+    return occlusionCuller == nullptr || !occlusionCuller->isOccluded(this);
 }
 
+bool RenderObject::isInFrustum() const
+{
+    // the camera only knows the latest step, so the sphere gets grown by the last move to cover the blended position too
+    const TransformComponent &transform = this->transform();
+    return transform.camera->isVisible(transform.localSlot, getBoundingRadius() + glm::length(transform.lastMove), renderData().near, renderData().far);
+}
+
+float RenderObject::getBoundingRadius() const
+{
+    // the bounding sphere grows with the biggest scale so rotating never pokes the mesh out of it
+    const BigVec3 &scale = transform().scale;
+    float biggestScale = std::max({std::abs(scale.x.toFloat()), std::abs(scale.y.toFloat()), std::abs(scale.z.toFloat())});
+    return renderData().mesh->radius * biggestScale;
+}
+
+glm::vec3 RenderObject::getLocalPosition() const
+{
+    // local is camera - position, so going back along the last move is adding it
+    const TransformComponent &transform = this->transform();
+    return transform.camera->getLocalPosition(transform.localSlot) + transform.lastMove * (1.0f - interpolation);
+}
+
+void RenderObject::fillInstance(InstanceData &instance)
+{
+    const RenderComponent &renderData = this->renderData();
+    const Light *light = entities.light(entity);
+    tempLocalPosition = getLocalPosition();
+    instance.model = getModelMatrix();
+    glm::vec2 depth = transform().camera->getDepthParameters(renderData.near, renderData.far);
+    instance.depth = glm::vec4(depth.x, depth.y, nearCullFunction(), 0.0f);
+
+    if (light != nullptr)
+        instance.emission = glm::vec4(light->color, calculateInverseSquareLaw(tempLocalPosition, light->intensity));
+    else
+        instance.emission = glm::vec4(0.0f);
+
+    LightChoice lights;
+    lightSelector.select(getLocalPosition(), light, lights);
+    for (int i = 0; i < MAX_OBJECT_LIGHTS; i++)
+        instance.lights[i] = i < lights.count ? lights.indices[i] : -1;
+    instance.ambient = glm::vec4(lights.ambient, 0.0f);
+}
+
+// camera->updateLocalPositions() has to have run this frame, that's where the local position comes from
 void RenderObject::Draw()
 {
-    tempLocalPosition = camera->convertToLocal(position);
-    backend->includeShader(shader);
-    addVarsToShader();
-    backend->includeTexture(image);
-    backend->finalizeShaders(vertices);
+    if (!isVisible())
+        return;
+    float distance = glm::length(getLocalPosition());
+    renderQueue.submit(RenderQueue::makeKey(renderData().transparent, renderData().shader->getShader(), renderData().image->getID(), distance), this);
+}
+
+void RenderObject::record(CommandBuffer &commands)
+{
+    const RenderComponent &renderData = this->renderData();
+    tempLocalPosition = getLocalPosition();
+    commands.includeShader(renderData.backend, renderData.shader);
+    addVarsToShader(commands);
+    commands.includeTexture(renderData.backend, renderData.image);
+    commands.finalizeShaders(renderData.backend);
 }
\ No newline at end of file
@@ -5,60 +5,169 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <vector>
 #include <cmath>
+#include <cfloat>
 #include <memory>
+#include <string>
 #include "Backend.hpp"
+#include "InstanceData.hpp"
+#include "MeshRegistry.hpp"
+#include "RenderQueue.hpp"
 #include "HelperFunctions.hpp"
 #include "Camera.hpp"
 #include "customMath/BigVec.hpp"
+#include "customMath/BigMath.hpp"
+#include "Light.hpp"
+#include "LightSelector.hpp"
+#include "SceneGraph.hpp"
+#include "EntityStore.hpp"
 
-struct Light
-{
-    BigVec3 &position;
-    glm::vec3 color;
-    Bigint intensity;
-};
 
-class RenderObject
+class OcclusionCuller;
+
+// a handle on one entity in entities, everything it has lives in the store and the getters and setters below go through to it
+class RenderObject : public Renderable
 {
+    Entity entity;
+
+    // the store moves rows around when things get destroyed, so these look the row up every time
+    TransformComponent &transform() { return entities.transform(entity); }
+    const TransformComponent &transform() const { return entities.transform(entity); }
+    MotionComponent &motion() { return entities.motion(entity); }
+    const MotionComponent &motion() const { return entities.motion(entity); }
+    RenderComponent &renderData() { return entities.render(entity); }
+    const RenderComponent &renderData() const { return entities.render(entity); }
+
 public:
     RenderObject(Backend *backend, Shader *shady, Image *im, Camera *cam, glm::vec3 emissionColor = glm::vec3(0, 0, 0), Bigint emissionIntensity = Bigint(), BigVec3 pos = BigVec3(0.0f), glm::vec3 rot = glm::vec3(0.0f), glm::vec3 scl = glm::vec3(1.0f));
     ~RenderObject();
 
+    // one fixed step of movement for this object, main does every entity in one go with entities.integrate instead
     void Update(float deltaTime);
+
+    // jumps to a position but still counts it as this step's move so drawing blends to it, use it after Update
+    void moveTo(const BigVec3 &target);
+
+    // children keep their position and rotation relative to the parent, the scale doesn't get passed down
+    // it stays where it is in the world when the parent changes, nullptr makes it a root again
+    void setParent(RenderObject *newParent);
+    RenderObject *getParent() const { return parent; }
+
+    // the setters call this, it's only needed after changing the components in entities yourself so the cached world transform gets redone
+    void markDirty();
+
+    // puts this object in renderQueue, its draw calls get recorded and played back when the queue gets flushed
+    // it doesn't bother if the object is off screen
     void Draw();
+    void record(CommandBuffer &commands);
+
+    // fills in what an instanced draw needs for this object, it's the same stuff Draw sends as uniforms
+    void fillInstance(InstanceData &instance);
+
+    // false when the camera definitely can't see any of it this frame, that's the frustum and then the occlusion culler if there is one
+    bool isVisible() const;
+    bool isInFrustum() const;
+
+    // a sphere around the camera local position that the mesh always fits in, whatever the rotation
+    float getBoundingRadius() const;
+    glm::vec3 getLocalPosition() const;
+    glm::mat4 getModelMatrix() const;
+
+    // objects with the same mesh, shader and image can get drawn together, see InstanceBatcher
+    const MeshHandle &getMesh() const { return renderData().mesh; }
+    Shader *getShader() const { return renderData().shader; }
+    Image *getImage() const { return renderData().image; }
+    Backend *getBackend() const { return renderData().backend; }
+    Entity getEntity() const { return entity; }
+
+    // always where it is in the world, with a parent setting it works out the local position that keeps it there
+    // it jumps straight there, use moveTo to have drawing blend to it
+    BigVec3 getPosition() const { return entities.position(entity); }
+    void setPosition(const BigVec3 &target);
+
+    // relative to the parent if there is one
+    glm::vec3 getRotation() const { return transform().rotation; }
+    void setRotation(const glm::vec3 &rotation)
+    {
+        transform().rotation = rotation;
+        markDirty();
+    }
 
-    BigVec3 position;
-    glm::vec3 rotation;
-    BigVec3 scale;
+    BigVec3 getScale() const { return transform().scale; }
+    void setScale(const BigVec3 &scale)
+    {
+        transform().scale = scale;
+        markDirty();
+    }
 
-    BigVec3 velocity;
-    BigVec3 acceleration;
+    BigVec3 getVelocity() const { return entities.velocity(entity); }
+    void setVelocity(const BigVec3 &velocity) { entities.setVelocity(entity, velocity); }
+
+    // in doubles, see MotionComponent
+    const glm::dvec3 &getAcceleration() const { return motion().acceleration; }
+    void setAcceleration(const glm::dvec3 &acceleration) { motion().acceleration = acceleration; }
+
+    // radians a second, it's -1 on every axis unless you change it
+    glm::vec3 getSpin() const { return motion().spin; }
+    void setSpin(const glm::vec3 &spin) { motion().spin = spin; }
+
+    // kilograms, anything above 0 gets pulled on and pulls on the others when there's a GravitySolver, and its acceleration gets overwritten
+    double getMass() const { return motion().mass; }
+    void setMass(double mass) { motion().mass = mass; }
 
     // change near and far values if you want to have big objects, if you change them to the right value it could be as big as the floating points will allow
-    float near = 0.1f;
-    float far = 10000.0f;
+    float getNear() const { return renderData().near; }
+    float getFar() const { return renderData().far; }
+    void setNear(float near) { renderData().near = near; }
+    void setFar(float far) { renderData().far = far; }
+
+    // transparent objects get drawn after the opaque ones, furthest first, with blending on
+    bool isTransparent() const { return renderData().transparent; }
+    void setTransparent(bool transparent) { renderData().transparent = transparent; }
 
     static float gamma;
     static bool disableBrightness;
 
+    // where drawing is between the state before the last Update (0) and after it (1), set it from SimulationClock::getAlpha
+    static float interpolation;
+
+    // decides which lights each object gets, tweak its settings to trade quality for speed
+    static LightSelector lightSelector;
+
+    // everything Draw submits to, flush it once all the objects have drawn
+    static RenderQueue renderQueue;
+
+    // set this to have hidden objects skipped too, it needs prepare() run on it every frame before anything draws
+    static OcclusionCuller *occlusionCuller;
+
+    // fills the camera and light data every object shares and sends it off, call once a frame before any Draw
+    static void uploadFrameData(const Camera &camera, HelperFunctions *renderer);
+
+    // who's parented to who, updateTransforms walks it
+    static SceneGraph scene;
+
+    // where every object's data actually lives
+    static EntityStore entities;
+
+    // works out world positions and matrices for whatever changed (and everything under it), run it after each step's Updates
+    static void updateTransforms();
+
 protected:
     void
-    addVarsToShader();
+    addVarsToShader(CommandBuffer &commands);
     RenderObject *parent = nullptr;
     void setupObject();
     float nearCullFunction() const;
-    glm::mat4 getModelMatrix() const;
+
+    // the local position that puts a child at worldPosition
+    BigVec3 offsetFromParent(const BigVec3 &worldPosition) const;
     BigVec3 tempLocalPosition;
 
+    // fills in the cached world rotation, model basis and (for children) position, the model matrix only needs the translation put in after
+    void updateWorldTransform();
+
 private:
-    Backend *backend;
-    Shader *shader;
-    Image *image;
-    Camera *camera;
-    Light *thisLight = nullptr;
-    std::vector<float> vertices;
-    Bigint calculateInverseSquareLaw(const BigVec3 &subtractedPos, const Bigint &intensity) const;
-    Bigint calculateDistanceSquared(const BigVec3 &subtractedPos) const;
-
-    static std::vector<Light *> allLights;
+    static float calculateInverseSquareLaw(const BigVec3 &subtractedPos, const Bigint &intensity);
+
+    static std::vector<Light *> allLights; // gatherLights fills it once a frame
+    static FrameData frameData;
 };
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "HelperFunctions.hpp"
+#include "CommandBuffer.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+
+// anything the render queue can draw
+class Renderable
+{
+public:
+    virtual ~Renderable() = default;
+
+    // writes its draw calls into commands, the queue calls this once everything's sorted
+    // it can be on any thread and at the same time as other renderables, so only read shared stuff
+    virtual void record(CommandBuffer &commands) = 0;
+};
+
+// things get submitted with a sort key during the frame and drawn all at once by flush, in key order
+// the key is set up so opaque stuff comes first, grouped by shader then texture then nearest first (so early z can throw out
+// what's behind it), and transparent stuff comes after that furthest first so blending comes out right
+//
+// opaque:      | pass (1) | shader (12) | texture (12) | depth (24) | unused (15) |
+// transparent: | pass (1) | inverted depth (24) | shader (12) | texture (12) | unused (15) |
+class RenderQueue
+{
+public:
+    // distance is how far it is from the camera, shader and texture are whatever ids the backend uses (only the low 12 bits count)
+    static uint64_t makeKey(bool transparent, unsigned shader, unsigned texture, float distance)
+    {
+        uint64_t state = (static_cast<uint64_t>(shader & 0xFFF) << 12) | (texture & 0xFFF);
+        uint64_t depth = quantizeDepth(distance);
+        if (!transparent)
+            return (state << 39) | (depth << 15);
+        return (1ull << 63) | ((0xFFFFFFull - depth) << 39) | (state << 15);
+    }
+
+    static bool isTransparent(uint64_t key)
+    {
+        return (key >> 63) != 0;
+    }
+
+    // the renderable has to stay alive until flush
+    void submit(uint64_t key, Renderable *renderable)
+    {
+        items.push_back(Item{key, renderable});
+    }
+
+    // sorts everything, draws it, and empties the queue for next frame
+    void flush(HelperFunctions *renderer)
+    {
+        sort();
+        resizeBuffers(1);
+        record(renderer, 0, items.size(), buffers[0]);
+        replay(renderer, 1);
+    }
+
+    // the same but the recording gets split over the job system into a buffer per chunk, then they get played back
+    // in order on this thread, so call it from the one with the gl context
+    void flush(HelperFunctions *renderer, JobSystem &jobs)
+    {
+        sort();
+        size_t chunks = std::max<size_t>(1, std::min<size_t>(items.size(), jobs.getThreadCount() * 4));
+        resizeBuffers(chunks);
+        jobs.parallelFor(chunks, 1, [&](size_t begin, size_t end)
+                         {
+                             for (size_t c = begin; c < end; c++)
+                                 record(renderer, items.size() * c / chunks, items.size() * (c + 1) / chunks, buffers[c]); });
+        replay(renderer, chunks);
+    }
+
+    // how many things the last flush drew
+    size_t getLastCount() const
+    {
+        return lastCount;
+    }
+
+private:
+    struct Item
+    {
+        uint64_t key;
+        Renderable *renderable;
+    };
+
+    std::vector<Item> items;
+    std::vector<Item> scratch; // kept around so sorting doesn't allocate every frame
+    std::vector<CommandBuffer> buffers; // these too, so recording doesn't
+    size_t lastCount = 0;
+
+    void resizeBuffers(size_t count)
+    {
+        if (buffers.size() < count)
+            buffers.resize(count);
+        for (size_t i = 0; i < count; i++)
+            buffers[i].clear();
+    }
+
+    // items [begin, end) into buffer, with the switch to the transparent pass wherever it lands
+    void record(HelperFunctions *renderer, size_t begin, size_t end, CommandBuffer &buffer)
+    {
+        PROFILE_ZONE("addVarsToShader"); // recording is where the uniforms get worked out now
+        for (size_t i = begin; i < end; i++)
+        {
+            if (isTransparent(items[i].key) && (i == 0 || !isTransparent(items[i - 1].key)))
+                buffer.beginPass(renderer, true);
+            items[i].renderable->record(buffer);
+        }
+    }
+
+    void replay(HelperFunctions *renderer, size_t chunks)
+    {
+        PROFILE_ZONE("finalizeShaders"); // and playing back is where they get sent to gl
+        renderer->beginPass(false);
+        for (size_t c = 0; c < chunks; c++)
+            buffers[c].replay();
+        if (!items.empty() && isTransparent(items.back().key))
+            renderer->beginPass(false);
+
+        lastCount = items.size();
+        items.clear();
+    }
+
+    // positive floats sort the same as their bits, so the top 24 bits after the sign are a log scale depth that
+    // covers everything from millimetres to light years without picking a range
+    static uint64_t quantizeDepth(float distance)
+    {
+        if (!(distance > 0.0f))
+            return 0;
+        uint32_t bits;
+        std::memcpy(&bits, &distance, sizeof(bits));
+        return (bits >> 7) & 0xFFFFFF;
+    }
+
+    // lsd radix sort a byte at a time, it's stable so things with the same key keep their submit order
+    // bytes that are the same for every item (the unused ones, usually a lot of the state) get skipped
+    void sort()
+    {
+        scratch.resize(items.size());
+        for (int shift = 0; shift < 64; shift += 8)
+        {
+            size_t counts[256] = {};
+            for (const Item &item : items)
+                counts[(item.key >> shift) & 0xFF]++;
+            if (counts[(items.empty() ? 0 : items[0].key >> shift) & 0xFF] == items.size())
+                continue;
+
+            size_t offset = 0;
+            for (size_t &count : counts)
+            {
+                size_t c = count;
+                count = offset;
+                offset += c;
+            }
+            for (const Item &item : items)
+                scratch[counts[(item.key >> shift) & 0xFF]++] = item;
+            items.swap(scratch);
+        }
+    }
+};
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+class RenderObject;
+
+// keeps who's parented to who and walks everything parents first in one flat array, so working out world
+// transforms only touches the ones that changed or had an ancestor change, a sub tree that never moves is just
+// a byte check per node
+// node ids stay the same for as long as the object's around, the walk order gets rebuilt when the hierarchy changes
+class SceneGraph
+{
+public:
+    int add(RenderObject *object)
+    {
+        hierarchyChanged = true;
+        if (!freeNodes.empty())
+        {
+            int node = freeNodes.back();
+            freeNodes.pop_back();
+            objects[node] = object;
+            parents[node] = -1;
+            dirty[node] = 1;
+            return node;
+        }
+        objects.push_back(object);
+        parents.push_back(-1);
+        dirty.push_back(1);
+        return static_cast<int>(objects.size()) - 1;
+    }
+
+    // gives back the children it had, they're roots now
+    std::vector<RenderObject *> remove(int node)
+    {
+        std::vector<RenderObject *> orphans;
+        for (size_t i = 0; i < parents.size(); i++)
+        {
+            if (parents[i] == node)
+            {
+                parents[i] = -1;
+                orphans.push_back(objects[i]);
+            }
+        }
+        objects[node] = nullptr;
+        parents[node] = -1;
+        dirty[node] = 0;
+        freeNodes.push_back(node);
+        hierarchyChanged = true;
+        return orphans;
+    }
+
+    // -1 makes it a root
+    void setParent(int node, int parent)
+    {
+        for (int above = parent; above != -1; above = parents[above])
+        {
+            if (above == node)
+                throw std::runtime_error("SceneGraph: that parent would make a loop");
+        }
+        parents[node] = parent;
+        dirty[node] = 1;
+        hierarchyChanged = true;
+    }
+
+    int getParent(int node) const
+    {
+        return parents[node];
+    }
+
+    // safe from Update on lots of threads at once since every node has its own byte
+    void markDirty(int node)
+    {
+        dirty[node] = 1;
+    }
+
+    // calls update(object) for everything that needs its world transform redone, always after its parent's
+    template <typename Fn>
+    void update(Fn &&updateObject)
+    {
+        if (hierarchyChanged)
+            rebuildOrder();
+
+        lastUpdated = 0;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            int node = order[i];
+            int parent = orderParents[i];
+            bool update = dirty[node] || (parent >= 0 && changed[parent]);
+            changed[i] = update;
+            if (update)
+            {
+                dirty[node] = 0;
+                updateObject(objects[node]);
+                lastUpdated++;
+            }
+        }
+    }
+
+    // how many had to be redone last update, everything static should keep this low
+    size_t getLastUpdated() const { return lastUpdated; }
+    size_t size() const { return order.size(); }
+
+private:
+    // indexed by node id
+    std::vector<RenderObject *> objects;
+    std::vector<int> parents;
+    std::vector<uint8_t> dirty; // not vector<bool>, that packs bits so threads would stomp on each other
+    std::vector<int> freeNodes;
+
+    // indexed by position in the walk, parents always come before their children
+    std::vector<int> order;
+    std::vector<int> orderParents; // position of the parent in order, -1 for roots
+    std::vector<uint8_t> changed;  // whether that one got redone this update
+
+    bool hierarchyChanged = false;
+    size_t lastUpdated = 0;
+
+    // depth first so a sub tree sits together in the arrays
+    void rebuildOrder()
+    {
+        // children lists packed into one array, counting sort style
+        std::vector<int> firstChild(objects.size() + 1, 0);
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            if (objects[i] != nullptr && parents[i] >= 0)
+                firstChild[parents[i] + 1]++;
+        }
+        for (size_t i = 0; i < objects.size(); i++)
+            firstChild[i + 1] += firstChild[i];
+        std::vector<int> children(firstChild.back());
+        std::vector<int> filled(firstChild.begin(), firstChild.end() - 1);
+        for (size_t i = 0; i < objects.size(); i++)
+        {
+            if (objects[i] != nullptr && parents[i] >= 0)
+                children[filled[parents[i]]++] = static_cast<int>(i);
+        }
+
+        order.clear();
+        orderParents.clear();
+        std::vector<std::pair<int, int>> stack; // node, position of its parent in order
+        for (size_t root = 0; root < objects.size(); root++)
+        {
+            if (objects[root] == nullptr || parents[root] >= 0)
+                continue;
+            stack.push_back({static_cast<int>(root), -1});
+            while (!stack.empty())
+            {
+                auto [node, parent] = stack.back();
+                stack.pop_back();
+                int position = static_cast<int>(order.size());
+                order.push_back(node);
+                orderParents.push_back(parent);
+                // pushed backwards so they come out in order
+                for (int c = firstChild[node + 1] - 1; c >= firstChild[node]; c--)
+                    stack.push_back({children[c], position});
+            }
+        }
+
+        // everything gets redone once after the order changes, it's rare and saves tracking what moved where
+        changed.assign(order.size(), 0);
+        for (int node : order)
+            dirty[node] = 1;
+        hierarchyChanged = false;
+    }
+};
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <algorithm>
+
+// runs the simulation at a fixed rate whatever the frame rate is
+// every frame advance() says how many fixed steps to run, the time left over carries to the next frame and
+// getAlpha() says how far between the last two steps the frame is so drawing can blend between them
+class SimulationClock
+{
+public:
+    // maxStepsPerFrame stops a slow frame from needing more steps, which makes the next frame slower and so on
+    SimulationClock(double stepsPerSecond = 60.0, int maxStepsPerFrame = 5)
+        : step(1.0 / stepsPerSecond), maxStepsPerFrame(maxStepsPerFrame)
+    {
+        frequency = SDL_GetPerformanceFrequency();
+        lastCounter = SDL_GetPerformanceCounter();
+    }
+
+    // reads the high resolution timer and gives back how many steps to run this frame
+    int advance()
+    {
+        uint64_t counter = SDL_GetPerformanceCounter();
+        double seconds = static_cast<double>(counter - lastCounter) / frequency;
+        lastCounter = counter;
+        return advanceBy(seconds);
+    }
+
+    // the same but with the frame time given, so a run can be made exactly the same every time for benchmarking
+    int advanceBy(double seconds)
+    {
+        frameTime = seconds;
+        accumulator += seconds;
+
+        int steps = static_cast<int>(accumulator / step);
+        if (steps > maxStepsPerFrame)
+        {
+            // whole steps we can't catch up on just get dropped, the bit left over still counts
+            droppedSteps += steps - maxStepsPerFrame;
+            accumulator -= (steps - maxStepsPerFrame) * step;
+            steps = maxStepsPerFrame;
+        }
+        accumulator -= steps * step;
+        stepCount += steps;
+        frameStartTime = time;
+        frameWarp = timeWarp;
+        time += steps * step * timeWarp;
+        return steps;
+    }
+
+    // the fixed time each step covers, pass this to Update
+    float getStep() const
+    {
+        return static_cast<float>(step);
+    }
+
+    // how long the last frame really took, for stuff that isn't simulated like moving the camera
+    float getFrameTime() const
+    {
+        return static_cast<float>(frameTime);
+    }
+
+    // 0 is the step before last, 1 is the last step
+    float getAlpha() const
+    {
+        return static_cast<float>(std::max(0.0, std::min(1.0, accumulator / step)));
+    }
+
+    // how much simulated time has gone by, time warp included
+    double getTime() const
+    {
+        return time;
+    }
+
+    // the time at the end of one of this frame's steps, 0 is the first one advance() gave back
+    double getStepTime(int index) const
+    {
+        return frameStartTime + (index + 1) * step * frameWarp;
+    }
+
+    // makes getTime go faster than real time, Update still gets the normal step so only stuff that goes by getTime
+    // (like orbits) speeds up and nothing integrated blows up
+    void setTimeWarp(double warp)
+    {
+        timeWarp = std::max(0.0, warp);
+    }
+
+    double getTimeWarp() const
+    {
+        return timeWarp;
+    }
+
+    uint64_t getStepCount() const
+    {
+        return stepCount;
+    }
+
+    // steps skipped because a frame took too long, if this keeps going up the simulation can't keep up
+    uint64_t getDroppedSteps() const
+    {
+        return droppedSteps;
+    }
+
+private:
+    double step;
+    int maxStepsPerFrame;
+    uint64_t frequency;
+    uint64_t lastCounter;
+    double accumulator = 0.0;
+    double frameTime = 0.0;
+    uint64_t stepCount = 0;
+    double time = 0.0;
+    double timeWarp = 1.0;
+    double frameStartTime = 0.0;
+    double frameWarp = 1.0; // what timeWarp was at the last advance, it can change before the steps run
+    uint64_t droppedSteps = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// every uniform name gets turned into a small number once, shaders keep their locations in a table indexed by it
+// so drawing never has to build strings or ask the driver where a uniform is
+using UniformId = int;
+
+class UniformNames
+{
+public:
+    // the id for name, makes a new one the first time it sees a name
+    static UniformId get(const std::string &name)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto found = ids().find(name);
+        if (found != ids().end())
+            return found->second;
+
+        UniformId id = static_cast<UniformId>(names().size());
+        ids().emplace(name, id);
+        names().push_back(name);
+        return id;
+    }
+
+    // the id for arrayName[index]
+    static UniformId get(const std::string &arrayName, int index)
+    {
+        return get(arrayName + "[" + std::to_string(index) + "]");
+    }
+
+    // ids for arrayName[0] up to arrayName[count - 1], build these once and keep them
+    static std::vector<UniformId> getArray(const std::string &arrayName, int count)
+    {
+        std::vector<UniformId> result;
+        result.reserve(count);
+        for (int i = 0; i < count; i++)
+            result.push_back(get(arrayName, i));
+        return result;
+    }
+
+    static std::string name(UniformId id)
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        return names()[id];
+    }
+
+    static size_t count()
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        return names().size();
+    }
+
+private:
+    static std::unordered_map<std::string, UniformId> &ids()
+    {
+        static std::unordered_map<std::string, UniformId> table;
+        return table;
+    }
+
+    static std::vector<std::string> &names()
+    {
+        static std::vector<std::string> table;
+        return table;
+    }
+
+    static std::mutex &mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+};
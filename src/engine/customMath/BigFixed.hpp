@@ -0,0 +1,212 @@
+#pragma once
+
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <sstream>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+#include "HybridInt.hpp"
+
+// a fixed point number with FracBits binary digits after the point, stored as value = real * 2^FracBits
+// since the scale is a power of two every rescale in * and / is just a shift
+// Storage has to act like an integer with shifts, HybridInt and cpp_int both work
+template <int FracBits, typename Storage = HybridInt>
+class BigFixed
+{
+public:
+    static_assert(FracBits > 0 && FracBits < 63, "FracBits has to leave room for the integer part");
+
+    static constexpr int FRAC_BITS = FracBits;
+    static constexpr __int128 ONE = static_cast<__int128>(1) << FracBits; // 1.0 in raw units
+    static constexpr int DECIMAL_PLACES = 5;                              // how many digits toString prints
+
+    Storage value;
+
+    BigFixed() : value() {}
+
+    BigFixed(double d) : value(rawFromDouble(d)) {}
+
+    BigFixed(float f) : value(rawFromDouble(f)) {}
+
+    BigFixed(int i) : value(rawFromInt(i)) {}
+
+    BigFixed(long l) : value(rawFromInt(l)) {}
+
+    // takes a decimal string like "-150000000000.25", the fraction gets rounded to the nearest raw unit
+    BigFixed(const std::string &s)
+    {
+        size_t start = (!s.empty() && (s[0] == '-' || s[0] == '+')) ? 1 : 0;
+        bool negative = start == 1 && s[0] == '-';
+
+        size_t dot = s.find('.');
+        std::string intPart = (dot == std::string::npos) ? s.substr(start) : s.substr(start, dot - start);
+        std::string fracPart = (dot == std::string::npos) ? "" : s.substr(dot + 1);
+
+        value = Storage(intPart.empty() ? std::string("0") : intPart);
+        value <<= FracBits;
+
+        if (!fracPart.empty())
+        {
+            Storage denominator = Storage("1" + std::string(fracPart.length(), '0'));
+            Storage fraction = Storage(fracPart);
+            fraction <<= FracBits;
+            value += (fraction + denominator / Storage(2)) / denominator;
+        }
+
+        if (negative)
+            value = -value;
+    }
+
+    // makes one straight from a raw value, for when you already have value * 2^FracBits
+    static BigFixed fromRaw(const Storage &raw)
+    {
+        BigFixed result;
+        result.value = raw;
+        return result;
+    }
+
+    // anything too big for an __int128 goes through cpp_int, which converts whole doubles exactly, inf and nan throw
+    static Storage rawFromDouble(double d)
+    {
+        if (!std::isfinite(d))
+            throw std::runtime_error("BigFixed can't hold " + std::to_string(d));
+
+        double scaled = d * static_cast<double>(ONE);
+        if (std::fabs(scaled) < std::ldexp(1.0, 126))
+            return Storage(static_cast<__int128>(scaled));
+
+        // past 2^53 a double has no fraction left, so shifting the whole part up loses nothing
+        Storage big = Storage(boost::multiprecision::cpp_int(d));
+        big <<= FracBits;
+        return big;
+    }
+
+    static constexpr __int128 rawFromInt(long long l)
+    {
+        return static_cast<__int128>(l) * ONE;
+    }
+
+    // the compound operators work on value directly so they don't build any temporaries
+    BigFixed &operator+=(const BigFixed &other)
+    {
+        value += other.value;
+        return *this;
+    }
+
+    BigFixed &operator-=(const BigFixed &other)
+    {
+        value -= other.value;
+        return *this;
+    }
+
+    BigFixed &operator*=(const BigFixed &other)
+    {
+        value *= other.value;
+        value >>= FracBits;
+        return *this;
+    }
+
+    BigFixed &operator/=(const BigFixed &other)
+    {
+        value <<= FracBits;
+        value /= other.value;
+        return *this;
+    }
+
+    BigFixed operator+(const BigFixed &other) const
+    {
+        BigFixed result(*this);
+        result += other;
+        return result;
+    }
+
+    BigFixed operator-(const BigFixed &other) const
+    {
+        BigFixed result(*this);
+        result -= other;
+        return result;
+    }
+
+    BigFixed operator*(const BigFixed &other) const
+    {
+        BigFixed result(*this);
+        result *= other;
+        return result;
+    }
+
+    BigFixed operator/(const BigFixed &other) const
+    {
+        BigFixed result(*this);
+        result /= other;
+        return result;
+    }
+
+    bool isZero() const
+    {
+        return value.is_zero();
+    }
+
+    bool operator<(const BigFixed &other) const
+    {
+        return value < other.value;
+    }
+
+    bool operator>(const BigFixed &other) const
+    {
+        return value > other.value;
+    }
+
+    bool operator==(const BigFixed &other) const
+    {
+        return value == other.value;
+    }
+
+    bool operator!=(const BigFixed &other) const
+    {
+        return value != other.value;
+    }
+
+    bool operator<=(const BigFixed &other) const
+    {
+        return value <= other.value;
+    }
+
+    bool operator>=(const BigFixed &other) const
+    {
+        return value >= other.value;
+    }
+
+    std::string toString() const
+    {
+        Storage magnitude = value.sign() < 0 ? Storage(-value) : value;
+        Storage intPart = magnitude >> FracBits;
+        Storage fracPart = magnitude - (intPart << FracBits);
+
+        Storage decimalScale = 1;
+        for (int i = 0; i < DECIMAL_PLACES; i++)
+            decimalScale *= Storage(10);
+        Storage fracDigits = (fracPart * decimalScale) >> FracBits;
+
+        std::ostringstream out;
+        if (value.sign() < 0)
+            out << "-";
+        out << intPart << "." << std::setw(DECIMAL_PLACES) << std::setfill('0') << fracDigits;
+        return out.str();
+    }
+
+    // anything out of range comes out as infinity because the conversion saturates
+    float toFloat() const
+    {
+        return static_cast<float>(toDouble());
+    }
+
+    double toDouble() const
+    {
+        return std::ldexp(static_cast<double>(value), -FracBits);
+    }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "BigVec.hpp"
+
+// math that works straight on the big fixed point numbers instead of going through double first,
+// everything looks at the leading bits first so numbers in the normal range never touch cpp_int
+namespace bigMath
+{
+    // n * 2^exponent as a double, works even when n is way too big for a double by only converting the top bits
+    inline double ldexpBig(const HybridInt &n, int exponent)
+    {
+        unsigned bits = n.bitLength();
+        if (bits < 1000)
+            return std::ldexp(static_cast<double>(n), exponent);
+        unsigned drop = bits - 64;
+        return std::ldexp(static_cast<double>(n >> drop), exponent + static_cast<int>(drop));
+    }
+
+    // floor(sqrt(n)), zero for anything that isn't positive
+    inline HybridInt isqrt(const HybridInt &n)
+    {
+        if (n.sign() <= 0)
+            return HybridInt();
+        if (n.isBig())
+            return HybridInt(boost::multiprecision::sqrt(n.toBig()));
+
+        unsigned __int128 v = static_cast<unsigned __int128>(n.smallValue());
+
+        // the double sqrt gets the leading 53 bits right, one newton step fixes the rest
+        unsigned __int128 x = static_cast<unsigned __int128>(std::sqrt(static_cast<double>(v)));
+        if (x != 0)
+            x = (x + v / x) / 2;
+        while (x * x > v)
+            x--;
+        while ((x + 1) * (x + 1) <= v)
+            x++;
+        return HybridInt(static_cast<__int128>(x));
+    }
+
+    template <int FracBits>
+    BigFixed<FracBits> isqrt(const BigFixed<FracBits> &f)
+    {
+        // sqrt(raw * 2^F) = sqrt(raw * 2^2F) / 2^F, so shift up by F before the integer sqrt
+        return BigFixed<FracBits>::fromRaw(isqrt(f.value << FracBits));
+    }
+
+    template <typename Fixed>
+    unsigned maxBitLength(const BigVec3T<Fixed> &v)
+    {
+        return std::max({v.x.value.bitLength(), v.y.value.bitLength(), v.z.value.bitLength()});
+    }
+
+    // sqrt(x^2 + y^2 + z^2), when the components are big it only squares their top 62 bits
+    template <int FracBits>
+    BigFixed<FracBits> length(const BigVec3T<BigFixed<FracBits>> &v)
+    {
+        unsigned bits = maxBitLength(v);
+        unsigned shift = bits > 62 ? bits - 62 : 0;
+
+        HybridInt x = v.x.value >> shift;
+        HybridInt y = v.y.value >> shift;
+        HybridInt z = v.z.value >> shift;
+        x *= x;
+        y *= y;
+        z *= z;
+        x += y;
+        x += z;
+
+        HybridInt root = isqrt(x);
+        root <<= shift;
+        return BigFixed<FracBits>::fromRaw(root);
+    }
+
+    // the direction of v as floats, scaled down by its leading bit first so it never overflows
+    template <typename Fixed>
+    glm::vec3 normalizeToFloat(const BigVec3T<Fixed> &v)
+    {
+        int bits = static_cast<int>(maxBitLength(v));
+        if (bits == 0)
+            return glm::vec3(0.0f);
+
+        glm::dvec3 d(
+            ldexpBig(v.x.value, -bits),
+            ldexpBig(v.y.value, -bits),
+            ldexpBig(v.z.value, -bits));
+        return glm::vec3(glm::normalize(d));
+    }
+
+    // intensity / |offset|^2 as a float, 1 when offset is zero
+    // each component gets scaled to below 1 by the shared leading bit so the squares stay in double range
+    // and the powers of two get put back in one ldexp at the end
+    template <int FracBits>
+    float inverseSquare(const BigFixed<FracBits> &intensity, const BigVec3T<BigFixed<FracBits>> &offset)
+    {
+        int bits = static_cast<int>(maxBitLength(offset));
+        if (bits == 0)
+            return 1.0f;
+
+        double x = ldexpBig(offset.x.value, -bits);
+        double y = ldexpBig(offset.y.value, -bits);
+        double z = ldexpBig(offset.z.value, -bits);
+        double lengthSquared = x * x + y * y + z * z;
+
+        // raw offset^2 = lengthSquared * 2^2bits and the real value is that over 2^2F, the intensity brings its own 2^-F
+        return static_cast<float>(ldexpBig(intensity.value, FracBits - 2 * bits) / lengthSquared);
+    }
+}
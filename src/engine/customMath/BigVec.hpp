@@ -1,153 +1,188 @@
 #pragma once
 
 #include "Bigint.hpp"
+#include "BigVecExpr.hpp"
 
-struct BigVec3
+// a vector of any of the BigFixed types, use BigVec3 unless you need a different precision
+template <typename Fixed>
+struct BigVec3T : BigVecExpr<BigVec3T<Fixed>, Fixed>
 {
-    Bigint x, y, z;
+    using Scalar = Fixed;
 
-    BigVec3() : x(Bigint(0)), y(Bigint(0)), z(Bigint(0)) {}
+    Fixed x, y, z;
 
-    BigVec3(Bigint x_, Bigint y_, Bigint z_)
-        : x(x_), y(y_), z(z_) {}
-
-    BigVec3(Bigint x_) : x(x_), y(x_), z(x_) {}
+    BigVec3T() : x(Fixed(0)), y(Fixed(0)), z(Fixed(0)) {}
 
-    BigVec3(glm::vec3 vec) : x(Bigint(vec.x)), y(Bigint(vec.y)), z(Bigint(vec.z)) {}
+    BigVec3T(Fixed x_, Fixed y_, Fixed z_)
+        : x(x_), y(y_), z(z_) {}
 
-    BigVec3 operator+(const BigVec3 &other) const
-    {
-        return BigVec3(x + other.x, y + other.y, z + other.z);
-    }
+    BigVec3T(Fixed x_) : x(x_), y(x_), z(x_) {}
 
-    BigVec3 operator-(const BigVec3 &other) const
-    {
-        return BigVec3(x - other.x, y - other.y, z - other.z);
-    }
+    BigVec3T(glm::vec3 vec) : x(Fixed(vec.x)), y(Fixed(vec.y)), z(Fixed(vec.z)) {}
 
-    BigVec3 operator*(const BigVec3 &other) const
-    {
-        return BigVec3(x * other.x, y * other.y, z * other.z);
-    }
+    // builds the vector out of a lazy expression like a + b * c
+    template <typename E>
+    BigVec3T(const BigVecExpr<E, Fixed> &expr)
+        : x(expr.self().component(0)), y(expr.self().component(1)), z(expr.self().component(2)) {}
 
-    BigVec3 operator/(const BigVec3 &other) const
+    template <typename E>
+    BigVec3T &operator=(const BigVecExpr<E, Fixed> &expr)
     {
-        return BigVec3(x / other.x, y / other.y, z / other.z);
+        const E &e = expr.self();
+        x = e.component(0);
+        y = e.component(1);
+        z = e.component(2);
+        return *this;
     }
 
-    BigVec3 operator+(const Bigint &other) const
+    const Fixed &component(int i) const
     {
-        return BigVec3(x + other, y + other, z + other);
+        return i == 0 ? x : (i == 1 ? y : z);
     }
 
-    BigVec3 operator-(const Bigint &other) const
+    // the compound operators all work in place, nothing gets built in between
+    template <typename E>
+    BigVec3T &operator+=(const BigVecExpr<E, Fixed> &expr)
     {
-        return BigVec3(x - other, y - other, z - other);
+        const E &e = expr.self();
+        x += e.component(0);
+        y += e.component(1);
+        z += e.component(2);
+        return *this;
     }
 
-    BigVec3 operator*(const Bigint &other) const
+    template <typename E>
+    BigVec3T &operator-=(const BigVecExpr<E, Fixed> &expr)
     {
-        return BigVec3(x * other, y * other, z * other);
+        const E &e = expr.self();
+        x -= e.component(0);
+        y -= e.component(1);
+        z -= e.component(2);
+        return *this;
     }
 
-    BigVec3 operator/(const Bigint &other) const
+    template <typename E>
+    BigVec3T &operator*=(const BigVecExpr<E, Fixed> &expr)
     {
-        return BigVec3(x / other, y / other, z / other);
+        const E &e = expr.self();
+        x *= e.component(0);
+        y *= e.component(1);
+        z *= e.component(2);
+        return *this;
     }
 
-    void operator+=(const BigVec3 &other)
+    template <typename E>
+    BigVec3T &operator/=(const BigVecExpr<E, Fixed> &expr)
     {
-        *this = *this + other;
+        const E &e = expr.self();
+        x /= e.component(0);
+        y /= e.component(1);
+        z /= e.component(2);
+        return *this;
     }
 
-    void operator-=(const BigVec3 &other)
+    // these take glm vectors and the like
+    BigVec3T &operator+=(const BigVec3T &other)
     {
-        *this = *this - other;
+        x += other.x;
+        y += other.y;
+        z += other.z;
+        return *this;
     }
 
-    void operator*=(const BigVec3 &other)
+    BigVec3T &operator-=(const BigVec3T &other)
     {
-        *this = *this * other;
+        x -= other.x;
+        y -= other.y;
+        z -= other.z;
+        return *this;
     }
 
-    void operator/=(const BigVec3 &other)
+    BigVec3T &operator*=(const BigVec3T &other)
     {
-        *this = *this / other;
+        x *= other.x;
+        y *= other.y;
+        z *= other.z;
+        return *this;
     }
 
-    void operator+=(const Bigint &other)
+    BigVec3T &operator/=(const BigVec3T &other)
     {
-        *this = *this + other;
+        x /= other.x;
+        y /= other.y;
+        z /= other.z;
+        return *this;
     }
 
-    void operator-=(const Bigint &other)
+    BigVec3T &operator+=(const Fixed &other)
     {
-        *this = *this - other;
+        x += other;
+        y += other;
+        z += other;
+        return *this;
     }
 
-    void operator*=(const Bigint &other)
+    BigVec3T &operator-=(const Fixed &other)
     {
-        *this = *this * other;
+        x -= other;
+        y -= other;
+        z -= other;
+        return *this;
     }
 
-    void operator/=(const Bigint &other)
+    BigVec3T &operator*=(const Fixed &other)
     {
-        *this = *this / other;
+        x *= other;
+        y *= other;
+        z *= other;
+        return *this;
     }
 
-    bool isZero() const
+    BigVec3T &operator/=(const Fixed &other)
     {
-        return x.isZero() && y.isZero() && z.isZero();
-    }
-
-    glm::vec3 toFloatVec3() const
-    {
-        return glm::vec3(
-            x.toFloat(),
-            y.toFloat(),
-            z.toFloat());
-    }
-
-    glm::dvec3 toDoubleVec3() const
-    {
-        return glm::dvec3(
-            x.toDouble(),
-            y.toDouble(),
-            z.toDouble());
+        x /= other;
+        y /= other;
+        z /= other;
+        return *this;
     }
 };
 
-struct BigVec2
+template <typename Fixed>
+struct BigVec2T
 {
-    Bigint x, y;
+    Fixed x, y;
 
-    BigVec2() : x(Bigint(0)), y(Bigint(0)) {}
+    BigVec2T() : x(Fixed(0)), y(Fixed(0)) {}
 
-    BigVec2(Bigint x, Bigint y)
+    BigVec2T(Fixed x, Fixed y)
         : x(x), y(y) {}
 
-    BigVec2(Bigint x_) : x(x_), y(x_) {}
+    BigVec2T(Fixed x_) : x(x_), y(x_) {}
 
-    BigVec2(glm::vec2 vec) : x(Bigint(vec.x)), y(Bigint(vec.y)) {}
+    BigVec2T(glm::vec2 vec) : x(Fixed(vec.x)), y(Fixed(vec.y)) {}
 
-    BigVec2 operator+(const BigVec2 &other) const
+    BigVec2T operator+(const BigVec2T &other) const
     {
-        return BigVec2(x + other.x, y + other.y);
+        return BigVec2T(x + other.x, y + other.y);
     }
 
-    BigVec2 operator-(const BigVec2 &other) const
+    BigVec2T operator-(const BigVec2T &other) const
     {
-        return BigVec2(x - other.x, y - other.y);
+        return BigVec2T(x - other.x, y - other.y);
     }
 
-    void operator+=(const BigVec2 &other)
+    BigVec2T &operator+=(const BigVec2T &other)
     {
-        *this = *this + other;
+        x += other.x;
+        y += other.y;
+        return *this;
     }
 
-    void operator-=(const BigVec2 &other)
+    BigVec2T &operator-=(const BigVec2T &other)
     {
-        *this = *this - other;
+        x -= other.x;
+        y -= other.y;
+        return *this;
     }
 
     glm::vec2 toFloatVec3() const
@@ -163,4 +198,7 @@ struct BigVec2
             x.toDouble(),
             y.toDouble());
     }
-};
\ No newline at end of file
+};
+
+using BigVec3 = BigVec3T<Bigint>;
+using BigVec2 = BigVec2T<Bigint>;
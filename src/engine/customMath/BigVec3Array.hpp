@@ -0,0 +1,634 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "BigVec.hpp"
+
+// one axis worth of fixed point numbers for a lot of entities, stored as two 64 bit limbs in their own arrays
+// (low limb and signed high limb) so the batch kernels just stream through memory
+// anything that doesn't fit in 128 bits gets "spilled" into a side table and goes through the normal Bigint code
+template <typename Fixed>
+class BigFixedColumn
+{
+public:
+    size_t size() const
+    {
+        return low.size();
+    }
+
+    void resize(size_t n)
+    {
+        for (auto it = spilled.begin(); it != spilled.end();)
+            it = it->first >= n ? spilled.erase(it) : std::next(it);
+        low.resize(n, 0);
+        high.resize(n, 0);
+        spillMask.resize(n, 0);
+        flags.resize(n, 0);
+    }
+
+    void reserve(size_t n)
+    {
+        low.reserve(n);
+        high.reserve(n);
+        spillMask.reserve(n);
+        flags.reserve(n);
+    }
+
+    void clear()
+    {
+        resize(0);
+        spilled.clear();
+    }
+
+    void push(const Fixed &f)
+    {
+        resize(size() + 1);
+        set(size() - 1, f);
+    }
+
+    // removes entry i by moving the last one into its place
+    void swapRemove(size_t i)
+    {
+        size_t last = size() - 1;
+        if (i != last)
+            set(i, get(last));
+        spilled.erase(last);
+        resize(last);
+    }
+
+    void set(size_t i, const Fixed &f)
+    {
+        if (f.value.isBig())
+        {
+            low[i] = 0;
+            high[i] = 0;
+            spillMask[i] = 1;
+            spilled[i] = f;
+            return;
+        }
+        if (spillMask[i])
+        {
+            spillMask[i] = 0;
+            spilled.erase(i);
+        }
+        __int128 v = f.value.smallValue();
+        low[i] = static_cast<uint64_t>(v);
+        high[i] = static_cast<int64_t>(v >> 64);
+    }
+
+    Fixed get(size_t i) const
+    {
+        if (spillMask[i])
+            return spilled.at(i);
+        return Fixed::fromRaw(HybridInt(join(low[i], high[i])));
+    }
+
+    // this[i] += other[i]
+    void add(const BigFixedColumn &other)
+    {
+        if (addLanes<false>(other))
+            fixUp([&](size_t i)
+                  { return get(i) + other.get(i); });
+    }
+
+    // this[i] -= other[i]
+    void subtract(const BigFixedColumn &other)
+    {
+        if (addLanes<true>(other))
+            fixUp([&](size_t i)
+                  { return get(i) - other.get(i); });
+    }
+
+    // this[i] *= s, rounded the same way as Bigint's multiply
+    void scale(float s)
+    {
+        int64_t sRaw;
+        if (!scalarToRaw(s, sRaw))
+        {
+            Fixed fs(s);
+            for (size_t i = 0; i < size(); i++)
+                set(i, get(i) * fs);
+            return;
+        }
+
+        auto step = [&](size_t i)
+        {
+            __int128 result;
+            uint8_t bad = spillMask[i] | !mulShift(join(low[i], high[i]), sRaw, result);
+            if (!bad)
+            {
+                low[i] = static_cast<uint64_t>(result);
+                high[i] = static_cast<int64_t>(result >> 64);
+            }
+            flags[i] = bad;
+            return bad != 0;
+        };
+
+        size_t n = size();
+        size_t i = 0;
+        bool any = false;
+
+#ifdef __AVX2__
+        if (fitsLaneScalar(sRaw))
+        {
+            const Lanes lanes(sRaw);
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i aLo = load(&low[i]);
+                __m256i aHi = load(&high[i]);
+                __m256i bad = spillLanes(spillMask, spillMask, i);
+                __m256i hi;
+                __m256i lo = lanes.mulShift(aLo, aHi, bad, hi);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&low[i]), _mm256_blendv_epi8(lo, aLo, bad));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&high[i]), _mm256_blendv_epi8(hi, aHi, bad));
+                any |= redoBadLanes(bad, i, step);
+            }
+        }
+#endif
+
+        for (; i < n; i++)
+            any |= step(i);
+
+        if (any)
+        {
+            Fixed fs(s);
+            fixUp([&](size_t i)
+                  { return get(i) * fs; });
+        }
+    }
+
+    // this[i] += other[i] * s, which is the velocity * deltaTime integration step
+    void addScaled(const BigFixedColumn &other, float s)
+    {
+        int64_t sRaw;
+        if (!scalarToRaw(s, sRaw))
+        {
+            Fixed fs(s);
+            for (size_t i = 0; i < size(); i++)
+                set(i, get(i) + other.get(i) * fs);
+            return;
+        }
+
+        auto step = [&](size_t i)
+        {
+            __int128 product = 0;
+            __int128 result;
+            uint8_t bad = spillMask[i] | other.spillMask[i];
+            bad |= !mulShift(join(other.low[i], other.high[i]), sRaw, product);
+            bad |= __builtin_add_overflow(join(low[i], high[i]), product, &result);
+            if (!bad)
+            {
+                low[i] = static_cast<uint64_t>(result);
+                high[i] = static_cast<int64_t>(result >> 64);
+            }
+            flags[i] = bad;
+            return bad != 0;
+        };
+
+        size_t n = size();
+        size_t i = 0;
+        bool any = false;
+
+#ifdef __AVX2__
+        if (fitsLaneScalar(sRaw))
+        {
+            const Lanes lanes(sRaw);
+            const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+            const __m256i zero = _mm256_setzero_si256();
+            for (; i + 4 <= n; i += 4)
+            {
+                __m256i bad = spillLanes(spillMask, other.spillMask, i);
+                __m256i pHi;
+                __m256i pLo = lanes.mulShift(load(&other.low[i]), load(&other.high[i]), bad, pHi);
+
+                // then the same 128 bit add as addLanes
+                __m256i aLo = load(&low[i]);
+                __m256i aHi = load(&high[i]);
+                __m256i lo = _mm256_add_epi64(aLo, pLo);
+                __m256i carry = _mm256_cmpgt_epi64(_mm256_xor_si256(aLo, signBit), _mm256_xor_si256(lo, signBit));
+                __m256i hi = _mm256_sub_epi64(_mm256_add_epi64(aHi, pHi), carry);
+                __m256i overflow = _mm256_and_si256(_mm256_xor_si256(aHi, hi), _mm256_xor_si256(pHi, hi));
+                bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(zero, overflow));
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&low[i]), _mm256_blendv_epi8(lo, aLo, bad));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(&high[i]), _mm256_blendv_epi8(hi, aHi, bad));
+                any |= redoBadLanes(bad, i, step);
+            }
+        }
+#endif
+
+        for (; i < n; i++)
+            any |= step(i);
+
+        if (any)
+        {
+            Fixed fs(s);
+            fixUp([&](size_t i)
+                  { return get(i) + other.get(i) * fs; });
+        }
+    }
+
+    // out[i * stride] = float(this[i] - origin)
+    void toFloat(float *out, size_t stride, const Fixed &origin = Fixed()) const
+    {
+        if (origin.value.isBig())
+        {
+            for (size_t i = 0; i < size(); i++)
+                out[i * stride] = (get(i) - origin).toFloat();
+            return;
+        }
+
+        __int128 o = origin.value.smallValue();
+        uint64_t oLow = static_cast<uint64_t>(o);
+        int64_t oHigh = static_cast<int64_t>(o >> 64);
+
+        auto convert = [&](size_t i)
+        {
+            uint64_t lo = low[i] - oLow;
+            int64_t hi = static_cast<int64_t>(static_cast<uint64_t>(high[i]) - static_cast<uint64_t>(oHigh) - (low[i] < oLow));
+            if (spillMask[i] || ((high[i] ^ oHigh) & (high[i] ^ hi)) < 0)
+                return (get(i) - origin).toFloat();
+            // converted as one __int128 so it rounds like the scalar toFloat, adding up the limbs as doubles cancels badly when hi is -1
+            return static_cast<float>(std::ldexp(static_cast<double>(join(lo, hi)), -Fixed::FRAC_BITS));
+        };
+
+        size_t n = size();
+        size_t i = 0;
+
+#ifdef __AVX2__
+        // a difference under 2^51 raw units turns into a double exactly by adding it to the bits of 1.5 * 2^52,
+        // after that it's the same exact scale and round to float as the scalar path so the results are bit for bit the same,
+        // bigger ones (past about 2 million km with 20 fraction bits) go through convert
+        const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i oLo4 = _mm256_set1_epi64x(static_cast<int64_t>(oLow));
+        const __m256i oHi4 = _mm256_set1_epi64x(oHigh);
+        const __m256i half = _mm256_set1_epi64x(INT64_C(1) << 51);
+        const __m256i magicBits = _mm256_set1_epi64x(INT64_C(0x4338000000000000));
+        const __m256d magic = _mm256_set1_pd(6755399441055744.0); // 1.5 * 2^52
+        const __m256d fraction = _mm256_set1_pd(std::ldexp(1.0, -Fixed::FRAC_BITS));
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i aLo = load(&low[i]);
+            __m256i aHi = load(&high[i]);
+            __m256i lo = _mm256_sub_epi64(aLo, oLo4);
+            __m256i borrow = _mm256_cmpgt_epi64(_mm256_xor_si256(oLo4, signBit), _mm256_xor_si256(aLo, signBit));
+            __m256i hi = _mm256_add_epi64(_mm256_sub_epi64(aHi, oHi4), borrow);
+
+            // fits when the high limb is only the low limb's sign and lo + 2^51 is under 2^52
+            __m256i fits = _mm256_and_si256(_mm256_cmpeq_epi64(hi, _mm256_cmpgt_epi64(zero, lo)),
+                                            _mm256_cmpeq_epi64(_mm256_srli_epi64(_mm256_add_epi64(lo, half), 52), zero));
+            __m256i bad = _mm256_or_si256(_mm256_andnot_si256(fits, _mm256_cmpeq_epi64(zero, zero)), spillLanes(spillMask, spillMask, i));
+
+            __m256d exact = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(lo, magicBits)), magic);
+            alignas(16) float results[4];
+            _mm_store_ps(results, _mm256_cvtpd_ps(_mm256_mul_pd(exact, fraction)));
+
+            int badLanes = _mm256_movemask_pd(_mm256_castsi256_pd(bad));
+            for (int l = 0; l < 4; l++)
+                out[(i + l) * stride] = (badLanes >> l) & 1 ? convert(i + l) : results[l];
+        }
+#endif
+
+        for (; i < n; i++)
+            out[i * stride] = convert(i);
+    }
+
+private:
+    std::vector<uint64_t> low;
+    std::vector<int64_t> high;
+    std::vector<uint8_t> spillMask;               // 1 when the real value is in spilled
+    mutable std::vector<uint8_t> flags;           // scratch, marks the entries a kernel left for fixUp
+    std::unordered_map<size_t, Fixed> spilled;
+
+    static __int128 join(uint64_t lo, int64_t hi)
+    {
+        return static_cast<__int128>((static_cast<unsigned __int128>(static_cast<uint64_t>(hi)) << 64) | lo);
+    }
+
+    // the float in raw units, false if it's too big to keep in 64 bits
+    static bool scalarToRaw(float s, int64_t &raw)
+    {
+        double scaled = static_cast<double>(s) * std::ldexp(1.0, Fixed::FRAC_BITS);
+        if (!(std::fabs(scaled) < std::ldexp(1.0, 62)))
+            return false;
+        raw = static_cast<int64_t>(scaled);
+        return true;
+    }
+
+    // floor(a * b / 2^FRAC_BITS), false if that doesn't fit in 128 bits
+    static bool mulShift(__int128 a, int64_t b, __int128 &out)
+    {
+        constexpr int shift = Fixed::FRAC_BITS;
+        bool negative = (a < 0) != (b < 0);
+        unsigned __int128 ua = a < 0 ? -static_cast<unsigned __int128>(a) : static_cast<unsigned __int128>(a);
+        uint64_t ub = b < 0 ? -static_cast<uint64_t>(b) : static_cast<uint64_t>(b);
+
+        // 192 bit product split as high (bits 64..191) and low64 (bits 0..63)
+        unsigned __int128 low128 = static_cast<unsigned __int128>(static_cast<uint64_t>(ua)) * ub;
+        unsigned __int128 high = static_cast<unsigned __int128>(static_cast<uint64_t>(ua >> 64)) * ub + (low128 >> 64);
+        uint64_t low64 = static_cast<uint64_t>(low128);
+
+        if ((high >> (63 + shift)) != 0)
+            return false;
+
+        unsigned __int128 q = (high << (64 - shift)) | (low64 >> shift);
+        if (negative)
+        {
+            // rounding down a negative number means rounding the magnitude up
+            q += (low64 & ((static_cast<uint64_t>(1) << shift) - 1)) != 0;
+            if (q > (static_cast<unsigned __int128>(1) << 127))
+                return false;
+            out = -static_cast<__int128>(q - 1) - 1;
+        }
+        else
+            out = static_cast<__int128>(q);
+        return true;
+    }
+
+#ifdef __AVX2__
+    static __m256i load(const void *p)
+    {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    // all ones in the lanes where either column's entry is spilled
+    static __m256i spillLanes(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b, size_t i)
+    {
+        int32_t aMask, bMask;
+        std::memcpy(&aMask, &a[i], 4);
+        std::memcpy(&bMask, &b[i], 4);
+        __m256i spills = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(aMask | bMask));
+        return _mm256_cmpgt_epi64(spills, _mm256_setzero_si256());
+    }
+
+    // the lanes the vector code couldn't do were left alone, they go through the kernel's scalar step instead
+    template <typename Step>
+    bool redoBadLanes(__m256i bad, size_t i, Step &step)
+    {
+        int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(bad));
+        bool any = false;
+        for (int l = 0; l < 4; l++)
+        {
+            flags[i + l] = 0;
+            if ((lanes >> l) & 1)
+                any |= step(i + l);
+        }
+        return any;
+    }
+
+    // the multiply only has 32 bit halves to work with, so the scalar has to fit in 32 bits, deltaTime is about 2^14
+    static bool fitsLaneScalar(int64_t sRaw)
+    {
+        return sRaw > -(INT64_C(1) << 32) && sRaw < (INT64_C(1) << 32);
+    }
+
+    // mulShift 4 at a time for values that fit in 64 bits
+    struct Lanes
+    {
+        __m256i sAbs, sSign;
+
+        explicit Lanes(int64_t sRaw) : sAbs(_mm256_set1_epi64x(sRaw < 0 ? -sRaw : sRaw)), sSign(_mm256_set1_epi64x(sRaw < 0 ? -1 : 0)) {}
+
+        // floor(v * s / 2^FRAC_BITS) as two limbs, lanes where v is more than 64 bits or the result is more than 63 get set in bad
+        __m256i mulShift(__m256i vLo, __m256i vHi, __m256i &bad, __m256i &hi) const
+        {
+            constexpr int shift = Fixed::FRAC_BITS;
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+
+            __m256i vSign = _mm256_cmpgt_epi64(zero, vLo);
+            bad = _mm256_or_si256(bad, _mm256_xor_si256(_mm256_cmpeq_epi64(vHi, vSign), _mm256_cmpeq_epi64(zero, zero)));
+            __m256i vAbs = _mm256_sub_epi64(_mm256_xor_si256(vLo, vSign), vSign);
+
+            // |v| * |s| is 96 bits, productHi:productLo, built from the two 32 bit halves of |v|
+            __m256i p0 = _mm256_mul_epu32(vAbs, sAbs);
+            __m256i p1 = _mm256_mul_epu32(_mm256_srli_epi64(vAbs, 32), sAbs);
+            __m256i productLo = _mm256_add_epi64(p0, _mm256_slli_epi64(p1, 32));
+            __m256i carry = _mm256_cmpgt_epi64(_mm256_xor_si256(p0, signBit), _mm256_xor_si256(productLo, signBit));
+            __m256i productHi = _mm256_sub_epi64(_mm256_srli_epi64(p1, 32), carry);
+            bad = _mm256_or_si256(bad, _mm256_cmpgt_epi64(_mm256_srli_epi64(productHi, shift - 1), zero));
+
+            __m256i q = _mm256_or_si256(_mm256_slli_epi64(productHi, 64 - shift), _mm256_srli_epi64(productLo, shift));
+
+            // rounding down a negative number means rounding the magnitude up
+            __m256i negative = _mm256_xor_si256(vSign, sSign);
+            __m256i inexact = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_and_si256(productLo, _mm256_set1_epi64x((INT64_C(1) << shift) - 1)), zero), negative);
+            q = _mm256_sub_epi64(q, inexact);
+
+            __m256i lo = _mm256_sub_epi64(_mm256_xor_si256(q, negative), negative);
+            hi = _mm256_cmpgt_epi64(zero, lo);
+            return lo;
+        }
+    };
+#endif
+
+    // 128 bit add or subtract of every entry with the carry done across the two limbs,
+    // entries that overflow or are spilled keep their old value and get flagged, returns true if any were
+    template <bool Subtract>
+    bool addLanes(const BigFixedColumn &other)
+    {
+        size_t n = size();
+        size_t i = 0;
+        bool any = false;
+
+#ifdef __AVX2__
+        const __m256i signBit = _mm256_set1_epi64x(INT64_MIN);
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i anyBad = zero;
+        for (; i + 4 <= n; i += 4)
+        {
+            __m256i aLo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&low[i]));
+            __m256i bLo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&other.low[i]));
+            __m256i aHi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&high[i]));
+            __m256i bHi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&other.high[i]));
+
+            // there's no unsigned 64 bit compare, so flip the sign bits and compare signed to find the carries
+            __m256i lo, hi, overflow;
+            if (Subtract)
+            {
+                lo = _mm256_sub_epi64(aLo, bLo);
+                __m256i borrow = _mm256_cmpgt_epi64(_mm256_xor_si256(bLo, signBit), _mm256_xor_si256(aLo, signBit));
+                hi = _mm256_add_epi64(_mm256_sub_epi64(aHi, bHi), borrow);
+                overflow = _mm256_and_si256(_mm256_xor_si256(aHi, bHi), _mm256_xor_si256(aHi, hi));
+            }
+            else
+            {
+                lo = _mm256_add_epi64(aLo, bLo);
+                __m256i carry = _mm256_cmpgt_epi64(_mm256_xor_si256(aLo, signBit), _mm256_xor_si256(lo, signBit));
+                hi = _mm256_sub_epi64(_mm256_add_epi64(aHi, bHi), carry);
+                overflow = _mm256_and_si256(_mm256_xor_si256(aHi, hi), _mm256_xor_si256(bHi, hi));
+            }
+            overflow = _mm256_cmpgt_epi64(zero, overflow);
+
+            int32_t aMask, bMask;
+            std::memcpy(&aMask, &spillMask[i], 4);
+            std::memcpy(&bMask, &other.spillMask[i], 4);
+            __m256i spills = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(aMask | bMask));
+            __m256i bad = _mm256_or_si256(overflow, _mm256_cmpgt_epi64(spills, zero));
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&low[i]), _mm256_blendv_epi8(lo, aLo, bad));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(&high[i]), _mm256_blendv_epi8(hi, aHi, bad));
+            anyBad = _mm256_or_si256(anyBad, bad);
+
+            int lanes = _mm256_movemask_pd(_mm256_castsi256_pd(bad));
+            for (int l = 0; l < 4; l++)
+                flags[i + l] = (lanes >> l) & 1;
+        }
+        any = !_mm256_testz_si256(anyBad, anyBad);
+#endif
+
+        for (; i < n; i++)
+        {
+            uint64_t aLo = low[i], bLo = other.low[i];
+            int64_t aHi = high[i], bHi = other.high[i];
+            uint64_t lo;
+            int64_t hi;
+            bool overflow;
+            if (Subtract)
+            {
+                lo = aLo - bLo;
+                hi = static_cast<int64_t>(static_cast<uint64_t>(aHi) - static_cast<uint64_t>(bHi) - (aLo < bLo));
+                overflow = ((aHi ^ bHi) & (aHi ^ hi)) < 0;
+            }
+            else
+            {
+                lo = aLo + bLo;
+                hi = static_cast<int64_t>(static_cast<uint64_t>(aHi) + static_cast<uint64_t>(bHi) + (lo < aLo));
+                overflow = ((aHi ^ hi) & (bHi ^ hi)) < 0;
+            }
+            uint8_t bad = overflow | spillMask[i] | other.spillMask[i];
+            low[i] = bad ? aLo : lo;
+            high[i] = bad ? aHi : hi;
+            flags[i] = bad;
+            any |= bad;
+        }
+        return any;
+    }
+
+    // redoes every flagged entry with the normal Bigint math, the kernels left those entries untouched
+    template <typename Op>
+    void fixUp(Op op)
+    {
+        for (size_t i = 0; i < size(); i++)
+        {
+            if (flags[i])
+                set(i, op(i));
+        }
+    }
+};
+
+// BigVec3s for lots of entities at once in structure of arrays form, one column per axis,
+// so something like integrating every velocity in the scene is three passes over contiguous memory
+// EntityStore keeps every position and velocity in one of these and integrate is positions.addScaled(velocities, deltaTime)
+template <typename Fixed>
+class BigVec3ArrayT
+{
+public:
+    using Vec = BigVec3T<Fixed>;
+
+    size_t size() const
+    {
+        return x.size();
+    }
+
+    void reserve(size_t n)
+    {
+        x.reserve(n);
+        y.reserve(n);
+        z.reserve(n);
+    }
+
+    void resize(size_t n)
+    {
+        x.resize(n);
+        y.resize(n);
+        z.resize(n);
+    }
+
+    void clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+    }
+
+    // adds one to the end and gives back where it went
+    size_t push(const Vec &v)
+    {
+        x.push(v.x);
+        y.push(v.y);
+        z.push(v.z);
+        return size() - 1;
+    }
+
+    void swapRemove(size_t i)
+    {
+        x.swapRemove(i);
+        y.swapRemove(i);
+        z.swapRemove(i);
+    }
+
+    void set(size_t i, const Vec &v)
+    {
+        x.set(i, v.x);
+        y.set(i, v.y);
+        z.set(i, v.z);
+    }
+
+    Vec get(size_t i) const
+    {
+        return Vec(x.get(i), y.get(i), z.get(i));
+    }
+
+    void add(const BigVec3ArrayT &other)
+    {
+        x.add(other.x);
+        y.add(other.y);
+        z.add(other.z);
+    }
+
+    void subtract(const BigVec3ArrayT &other)
+    {
+        x.subtract(other.x);
+        y.subtract(other.y);
+        z.subtract(other.z);
+    }
+
+    void scale(float s)
+    {
+        x.scale(s);
+        y.scale(s);
+        z.scale(s);
+    }
+
+    // this[i] += other[i] * s, e.g. positions.addScaled(velocities, deltaTime)
+    void addScaled(const BigVec3ArrayT &other, float s)
+    {
+        x.addScaled(other.x, s);
+        y.addScaled(other.y, s);
+        z.addScaled(other.z, s);
+    }
+
+    // writes every entry minus origin as floats, out needs room for size() vectors
+    void toFloat(glm::vec3 *out, const Vec &origin = Vec()) const
+    {
+        float *f = &out[0].x;
+        x.toFloat(f, 3, origin.x);
+        y.toFloat(f + 1, 3, origin.y);
+        z.toFloat(f + 2, 3, origin.z);
+    }
+
+    BigFixedColumn<Fixed> x, y, z;
+};
+
+using BigVec3Array = BigVec3ArrayT<Bigint>;
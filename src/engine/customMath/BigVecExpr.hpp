@@ -0,0 +1,151 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// lazy vector expressions, so something like position += velocity * deltaTime works one component at a time
+// straight into position without building any in between vectors
+// the nodes only keep references to the vectors they were made from, so don't hang on to one past the line it was made on
+
+template <typename Fixed>
+struct BigVec3T;
+
+template <typename Derived, typename Fixed>
+struct BigVecExpr
+{
+    const Derived &self() const
+    {
+        return static_cast<const Derived &>(*this);
+    }
+
+    BigVec3T<Fixed> eval() const
+    {
+        return BigVec3T<Fixed>(*this);
+    }
+
+    bool isZero() const
+    {
+        return self().component(0).isZero() && self().component(1).isZero() && self().component(2).isZero();
+    }
+
+    glm::vec3 toFloatVec3() const
+    {
+        return glm::vec3(
+            self().component(0).toFloat(),
+            self().component(1).toFloat(),
+            self().component(2).toFloat());
+    }
+
+    glm::dvec3 toDoubleVec3() const
+    {
+        return glm::dvec3(
+            self().component(0).toDouble(),
+            self().component(1).toDouble(),
+            self().component(2).toDouble());
+    }
+};
+
+namespace bigVecOps
+{
+    struct Add
+    {
+        template <typename Fixed>
+        static Fixed apply(Fixed a, const Fixed &b) { return a += b; }
+    };
+
+    struct Subtract
+    {
+        template <typename Fixed>
+        static Fixed apply(Fixed a, const Fixed &b) { return a -= b; }
+    };
+
+    struct Multiply
+    {
+        template <typename Fixed>
+        static Fixed apply(Fixed a, const Fixed &b) { return a *= b; }
+    };
+
+    struct Divide
+    {
+        template <typename Fixed>
+        static Fixed apply(Fixed a, const Fixed &b) { return a /= b; }
+    };
+}
+
+// vector (op) vector, one component at a time
+template <typename L, typename R, typename Op, typename Fixed>
+struct BigVecBinary : BigVecExpr<BigVecBinary<L, R, Op, Fixed>, Fixed>
+{
+    const L &left;
+    const R &right;
+
+    BigVecBinary(const L &l, const R &r) : left(l), right(r) {}
+
+    Fixed component(int i) const
+    {
+        return Op::apply(Fixed(left.component(i)), right.component(i));
+    }
+};
+
+// vector (op) number, the number is kept by value because it's usually a float that just got converted
+template <typename L, typename Op, typename Fixed>
+struct BigVecScalar : BigVecExpr<BigVecScalar<L, Op, Fixed>, Fixed>
+{
+    const L &left;
+    const Fixed scalar;
+
+    BigVecScalar(const L &l, const Fixed &s) : left(l), scalar(s) {}
+
+    Fixed component(int i) const
+    {
+        return Op::apply(Fixed(left.component(i)), scalar);
+    }
+};
+
+template <typename L, typename R, typename Fixed>
+BigVecBinary<L, R, bigVecOps::Add, Fixed> operator+(const BigVecExpr<L, Fixed> &l, const BigVecExpr<R, Fixed> &r)
+{
+    return {l.self(), r.self()};
+}
+
+template <typename L, typename R, typename Fixed>
+BigVecBinary<L, R, bigVecOps::Subtract, Fixed> operator-(const BigVecExpr<L, Fixed> &l, const BigVecExpr<R, Fixed> &r)
+{
+    return {l.self(), r.self()};
+}
+
+template <typename L, typename R, typename Fixed>
+BigVecBinary<L, R, bigVecOps::Multiply, Fixed> operator*(const BigVecExpr<L, Fixed> &l, const BigVecExpr<R, Fixed> &r)
+{
+    return {l.self(), r.self()};
+}
+
+template <typename L, typename R, typename Fixed>
+BigVecBinary<L, R, bigVecOps::Divide, Fixed> operator/(const BigVecExpr<L, Fixed> &l, const BigVecExpr<R, Fixed> &r)
+{
+    return {l.self(), r.self()};
+}
+
+// the number versions take a plain Fixed (no template deduction on it) so floats and ints still convert like before
+template <typename L, typename Fixed>
+BigVecScalar<L, bigVecOps::Add, Fixed> operator+(const BigVecExpr<L, Fixed> &l, const typename BigVec3T<Fixed>::Scalar &s)
+{
+    return {l.self(), s};
+}
+
+template <typename L, typename Fixed>
+BigVecScalar<L, bigVecOps::Subtract, Fixed> operator-(const BigVecExpr<L, Fixed> &l, const typename BigVec3T<Fixed>::Scalar &s)
+{
+    return {l.self(), s};
+}
+
+template <typename L, typename Fixed>
+BigVecScalar<L, bigVecOps::Multiply, Fixed> operator*(const BigVecExpr<L, Fixed> &l, const typename BigVec3T<Fixed>::Scalar &s)
+{
+    return {l.self(), s};
+}
+
+template <typename L, typename Fixed>
+BigVecScalar<L, bigVecOps::Divide, Fixed> operator/(const BigVecExpr<L, Fixed> &l, const typename BigVec3T<Fixed>::Scalar &s)
+{
+    return {l.self(), s};
+}
@@ -0,0 +1,341 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <stdexcept>
+
+#include <boost/multiprecision/cpp_int.hpp>
+
+// an integer that lives in a plain __int128 and only turns into a cpp_int when a result actually doesn't fit,
+// almost every number in a scene fits in 128 bits so this keeps the normal case away from the multiprecision code
+class HybridInt
+{
+public:
+    using Big = boost::multiprecision::cpp_int;
+
+    HybridInt() : small(0) {}
+
+    HybridInt(int i) : small(i) {}
+
+    HybridInt(long l) : small(l) {}
+
+    HybridInt(long long l) : small(l) {}
+
+    HybridInt(__int128 i) : small(i) {}
+
+    HybridInt(const Big &b) : small(0)
+    {
+        assign(b);
+    }
+
+    // parses a plain decimal number, anything weird gets handed to cpp_int so it throws the same errors
+    explicit HybridInt(const std::string &s) : small(0)
+    {
+        size_t i = 0;
+        bool negative = false;
+        if (i < s.size() && (s[i] == '-' || s[i] == '+'))
+            negative = s[i++] == '-';
+
+        bool ok = i < s.size();
+        __int128 result = 0;
+        for (; ok && i < s.size(); i++)
+        {
+            if (s[i] < '0' || s[i] > '9' ||
+                __builtin_mul_overflow(result, 10, &result) ||
+                __builtin_add_overflow(result, s[i] - '0', &result))
+                ok = false;
+        }
+
+        if (ok)
+            small = negative ? -result : result;
+        else
+            assign(Big(s));
+    }
+
+    HybridInt(const HybridInt &other) : small(other.small), big(other.big ? std::make_unique<Big>(*other.big) : nullptr) {}
+
+    HybridInt(HybridInt &&other) noexcept = default;
+
+    HybridInt &operator=(const HybridInt &other)
+    {
+        if (this != &other)
+        {
+            small = other.small;
+            if (other.big)
+                big = std::make_unique<Big>(*other.big);
+            else
+                big.reset();
+        }
+        return *this;
+    }
+
+    HybridInt &operator=(HybridInt &&other) noexcept = default;
+
+    // true when the value didn't fit in 128 bits and got moved to the heap
+    bool isBig() const
+    {
+        return big != nullptr;
+    }
+
+    // the inline value, only means anything when isBig() is false
+    __int128 smallValue() const
+    {
+        return small;
+    }
+
+    Big toBig() const
+    {
+        return big ? *big : fromInt128(small);
+    }
+
+    HybridInt &operator+=(const HybridInt &other)
+    {
+        __int128 result;
+        if (!big && !other.big && !__builtin_add_overflow(small, other.small, &result))
+        {
+            small = result;
+            return *this;
+        }
+        assign(toBig() + other.toBig());
+        return *this;
+    }
+
+    HybridInt &operator-=(const HybridInt &other)
+    {
+        __int128 result;
+        if (!big && !other.big && !__builtin_sub_overflow(small, other.small, &result))
+        {
+            small = result;
+            return *this;
+        }
+        assign(toBig() - other.toBig());
+        return *this;
+    }
+
+    HybridInt &operator*=(const HybridInt &other)
+    {
+        __int128 result;
+        if (!big && !other.big && !__builtin_mul_overflow(small, other.small, &result))
+        {
+            small = result;
+            return *this;
+        }
+        assign(toBig() * other.toBig());
+        return *this;
+    }
+
+    HybridInt &operator/=(const HybridInt &other)
+    {
+        if (!big && !other.big)
+        {
+            if (other.small == 0)
+                throw std::overflow_error("Division by zero.");
+            if (!(small == MIN_SMALL && other.small == -1))
+            {
+                small /= other.small;
+                return *this;
+            }
+        }
+        assign(toBig() / other.toBig());
+        return *this;
+    }
+
+    HybridInt &operator%=(const HybridInt &other)
+    {
+        if (!big && !other.big)
+        {
+            if (other.small == 0)
+                throw std::overflow_error("Division by zero.");
+            small = other.small == -1 ? 0 : small % other.small;
+            return *this;
+        }
+        assign(toBig() % other.toBig());
+        return *this;
+    }
+
+    HybridInt &operator<<=(unsigned n)
+    {
+        if (!big && small == 0)
+            return *this;
+        if (!big && bitLength() + n < 127)
+        {
+            small *= static_cast<__int128>(1) << n;
+            return *this;
+        }
+        assign(toBig() << n);
+        return *this;
+    }
+
+    // rounds towards negative infinity, same as cpp_int
+    HybridInt &operator>>=(unsigned n)
+    {
+        if (!big)
+        {
+            small = n < 127 ? small >> n : (small < 0 ? -1 : 0);
+            return *this;
+        }
+        assign(*big >> n);
+        return *this;
+    }
+
+    HybridInt operator+(const HybridInt &other) const
+    {
+        HybridInt result(*this);
+        result += other;
+        return result;
+    }
+
+    HybridInt operator-(const HybridInt &other) const
+    {
+        HybridInt result(*this);
+        result -= other;
+        return result;
+    }
+
+    HybridInt operator*(const HybridInt &other) const
+    {
+        HybridInt result(*this);
+        result *= other;
+        return result;
+    }
+
+    HybridInt operator/(const HybridInt &other) const
+    {
+        HybridInt result(*this);
+        result /= other;
+        return result;
+    }
+
+    HybridInt operator%(const HybridInt &other) const
+    {
+        HybridInt result(*this);
+        result %= other;
+        return result;
+    }
+
+    HybridInt operator<<(unsigned n) const
+    {
+        HybridInt result(*this);
+        result <<= n;
+        return result;
+    }
+
+    HybridInt operator>>(unsigned n) const
+    {
+        HybridInt result(*this);
+        result >>= n;
+        return result;
+    }
+
+    HybridInt operator-() const
+    {
+        HybridInt result;
+        result -= *this;
+        return result;
+    }
+
+    bool is_zero() const
+    {
+        return !big && small == 0;
+    }
+
+    int sign() const
+    {
+        if (big)
+            return big->sign();
+        return (small > 0) - (small < 0);
+    }
+
+    // how many bits the magnitude takes up, 0 for zero
+    unsigned bitLength() const
+    {
+        if (big)
+            return big->is_zero() ? 0 : boost::multiprecision::msb(abs(*big)) + 1;
+        unsigned __int128 magnitude = small < 0 ? -static_cast<unsigned __int128>(small) : static_cast<unsigned __int128>(small);
+        uint64_t high = static_cast<uint64_t>(magnitude >> 64);
+        uint64_t low = static_cast<uint64_t>(magnitude);
+        if (high != 0)
+            return 128 - __builtin_clzll(high);
+        return low != 0 ? 64 - __builtin_clzll(low) : 0;
+    }
+
+    int compare(const HybridInt &other) const
+    {
+        if (!big && !other.big)
+            return (small > other.small) - (small < other.small);
+        return toBig().compare(other.toBig());
+    }
+
+    bool operator<(const HybridInt &other) const { return compare(other) < 0; }
+    bool operator>(const HybridInt &other) const { return compare(other) > 0; }
+    bool operator<=(const HybridInt &other) const { return compare(other) <= 0; }
+    bool operator>=(const HybridInt &other) const { return compare(other) >= 0; }
+    bool operator==(const HybridInt &other) const { return compare(other) == 0; }
+    bool operator!=(const HybridInt &other) const { return compare(other) != 0; }
+
+    explicit operator double() const
+    {
+        return big ? big->convert_to<double>() : static_cast<double>(small);
+    }
+
+    explicit operator float() const
+    {
+        return big ? big->convert_to<float>() : static_cast<float>(small);
+    }
+
+    std::string str() const
+    {
+        return toBig().str();
+    }
+
+    friend std::ostream &operator<<(std::ostream &out, const HybridInt &h)
+    {
+        return out << h.str();
+    }
+
+    friend HybridInt abs(const HybridInt &h)
+    {
+        return h.sign() < 0 ? -h : h;
+    }
+
+private:
+    static constexpr __int128 MAX_SMALL = static_cast<__int128>(~static_cast<unsigned __int128>(0) >> 1);
+    static constexpr __int128 MIN_SMALL = -MAX_SMALL - 1;
+
+    __int128 small;
+    std::unique_ptr<Big> big; // only set when the value is too big for small
+
+    // stores a cpp_int result, dropping back to the inline value whenever it fits again
+    void assign(const Big &b)
+    {
+        if (b.is_zero() || boost::multiprecision::msb(abs(b)) < 127)
+        {
+            small = toInt128(b);
+            big.reset();
+        }
+        else if (big)
+            *big = b;
+        else
+            big = std::make_unique<Big>(b);
+    }
+
+    static Big fromInt128(__int128 i)
+    {
+        unsigned __int128 magnitude = i < 0 ? -static_cast<unsigned __int128>(i) : static_cast<unsigned __int128>(i);
+        Big result = static_cast<unsigned long long>(magnitude >> 64);
+        result <<= 64;
+        result |= static_cast<unsigned long long>(magnitude);
+        return i < 0 ? Big(-result) : result;
+    }
+
+    // only call this with something that fits
+    static __int128 toInt128(const Big &b)
+    {
+        Big magnitude = abs(b);
+        unsigned __int128 result = static_cast<unsigned long long>(magnitude >> 64);
+        result = (result << 64) | static_cast<unsigned long long>(magnitude & std::numeric_limits<unsigned long long>::max());
+        return b.sign() < 0 ? -static_cast<__int128>(result) : static_cast<__int128>(result);
+    }
+};
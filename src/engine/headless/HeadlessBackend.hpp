@@ -0,0 +1,108 @@
+#pragma once
+
+#include <vector>
+#include "../Backend.hpp"
+#include "HelperFunctionsHeadless.hpp"
+
+// does what OpenGlBackend does, skipped binds and all, but writes it into HeadlessState::log instead of calling gl
+class HeadlessBackend : public Backend
+{
+public:
+    MeshBuffer *createMeshBuffer(const std::vector<float> &vertices)
+    {
+        return new MeshBufferHeadless(vertices);
+    }
+
+    void setupObject(MeshBuffer *mesh)
+    {
+        this->mesh = mesh;
+    }
+
+    void includeShader(Shader *shader)
+    {
+        this->shader = shader;
+        if (HeadlessState::program == shader->getShader())
+        {
+            HeadlessState::log.current.redundantBinds++;
+            return;
+        }
+        HeadlessState::program = shader->getShader();
+        HeadlessState::log.record(CommandType::BindShader, HeadlessState::program);
+        HeadlessState::log.current.shaderChanges++;
+    }
+
+    using Backend::includeBool;
+    using Backend::includeFloat;
+    using Backend::includeInt;
+    using Backend::includeMat4;
+    using Backend::includeTripleFloat;
+
+    void includeMat4(UniformId location, const glm::mat4 &/*mat*/)
+    {
+        setUniform(location);
+    }
+
+    void includeTexture(Image *image)
+    {
+        static const UniformId TEXTURE = UniformNames::get("texture1");
+
+        if (HeadlessState::texture != image->getID())
+        {
+            HeadlessState::texture = image->getID();
+            HeadlessState::log.record(CommandType::BindTexture, HeadlessState::texture);
+            HeadlessState::log.current.textureChanges++;
+        }
+        else
+        {
+            HeadlessState::log.current.redundantBinds++;
+        }
+        setUniform(TEXTURE);
+    }
+
+    void includeFloat(UniformId location, const float /*f*/)
+    {
+        setUniform(location);
+    }
+
+    void includeTripleFloat(UniformId location, const float /*f1*/, const float /*f2*/, const float /*f3*/)
+    {
+        setUniform(location);
+    }
+
+    void includeInt(UniformId location, const int /*i*/)
+    {
+        setUniform(location);
+    }
+
+    void includeBool(UniformId location, const bool /*b*/)
+    {
+        setUniform(location);
+    }
+
+    void finalizeShaders()
+    {
+        HeadlessState::log.record(CommandType::Draw, mesh->getID(), static_cast<uint32_t>(mesh->getVertexCount()));
+        HeadlessState::log.current.draws++;
+        HeadlessState::log.current.vertices += mesh->getVertexCount();
+    }
+
+    void drawInstanced(const std::vector<InstanceData> &instances)
+    {
+        if (instances.empty())
+            return;
+
+        HeadlessState::log.record(CommandType::DrawInstanced, mesh->getID(), static_cast<uint32_t>(instances.size()));
+        CommandCounters &counters = HeadlessState::log.current;
+        counters.draws++;
+        counters.instancedDraws++;
+        counters.instances += instances.size();
+        counters.vertices += static_cast<uint64_t>(mesh->getVertexCount()) * instances.size();
+    }
+
+private:
+    void setUniform(UniformId location)
+    {
+        HeadlessState::log.record(CommandType::SetUniform, static_cast<uint32_t>(location), shader->getShader());
+        HeadlessState::log.current.uniformSets++;
+    }
+};
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <ostream>
+#include "../HelperFunctions.hpp"
+#include "../MeshRegistry.hpp"
+
+// everything the renderer asks for gets written down here instead of going to a gpu, so the render path can run
+// on a machine with no gl context and a benchmark or check can look at what it would have done
+enum class CommandType : uint8_t
+{
+    Clear,
+    Swap,
+    UploadFrameData, // a is the light count
+    BeginPass,       // a is 1 for the transparent pass
+    CreateMesh,      // a is the mesh id, b the vertex count
+    BindShader,      // a is the program
+    BindTexture,     // a is the texture
+    SetUniform,      // a is the UniformId, b the program it went to
+    Draw,            // a is the mesh id, b the vertex count
+    DrawInstanced,   // a is the mesh id, b the instance count
+};
+
+struct Command
+{
+    CommandType type;
+    uint32_t a;
+    uint32_t b;
+};
+
+struct CommandCounters
+{
+    uint64_t draws = 0; // instanced ones too
+    uint64_t instancedDraws = 0;
+    uint64_t instances = 0;
+    uint64_t vertices = 0; // times the instances
+    uint64_t shaderChanges = 0;
+    uint64_t textureChanges = 0;
+    uint64_t redundantBinds = 0; // shader or texture binds the opengl backend would have skipped
+    uint64_t uniformSets = 0;
+    uint64_t frameUploads = 0;
+    uint64_t passes = 0;
+    uint64_t meshUploads = 0;
+
+    void add(const CommandCounters &other)
+    {
+        draws += other.draws;
+        instancedDraws += other.instancedDraws;
+        instances += other.instances;
+        vertices += other.vertices;
+        shaderChanges += other.shaderChanges;
+        textureChanges += other.textureChanges;
+        redundantBinds += other.redundantBinds;
+        uniformSets += other.uniformSets;
+        frameUploads += other.frameUploads;
+        passes += other.passes;
+        meshUploads += other.meshUploads;
+    }
+};
+
+class CommandLog
+{
+public:
+    // turn this off to just keep the counters, so timing the submission isn't timing the log growing
+    bool recording = true;
+
+    void record(CommandType type, uint32_t a = 0, uint32_t b = 0)
+    {
+        if (recording)
+            commands.push_back(Command{type, a, b});
+    }
+
+    // what this frame's done so far, the backends add to it as they go
+    CommandCounters current;
+
+    // swapBuffer calls this
+    void endFrame()
+    {
+        lastFrame = current;
+        total.add(current);
+        current = CommandCounters();
+        frames++;
+    }
+
+    const CommandCounters &getLastFrame() const { return lastFrame; }
+    const CommandCounters &getTotal() const { return total; }
+    uint64_t getFrames() const { return frames; }
+    const std::vector<Command> &getCommands() const { return commands; }
+
+    void clear()
+    {
+        commands.clear();
+        current = CommandCounters();
+        lastFrame = CommandCounters();
+        total = CommandCounters();
+        frames = 0;
+    }
+
+    // one command a line, with the uniform names put back in
+    void dump(std::ostream &out) const
+    {
+        static const char *NAMES[] = {"clear", "swap", "frame_data", "pass", "create_mesh", "shader", "texture", "uniform", "draw", "draw_instanced"};
+        for (const Command &command : commands)
+        {
+            out << NAMES[static_cast<int>(command.type)];
+            if (command.type == CommandType::SetUniform)
+                out << " " << UniformNames::name(command.a) << " program " << command.b;
+            else
+                out << " " << command.a << " " << command.b;
+            out << "\n";
+        }
+    }
+
+private:
+    std::vector<Command> commands;
+    CommandCounters lastFrame;
+    CommandCounters total;
+    uint64_t frames = 0;
+};
+
+// the headless version of GlBindings plus the one log everything writes to, none of it's thread safe
+// (the gl side isn't either) so only record from the thread that would have owned the context
+struct HeadlessState
+{
+    static inline CommandLog log;
+    static inline unsigned int program = 0;
+    static inline unsigned int texture = 0;
+    static inline unsigned int nextId = 1; // ids start at 1 like gl's, 0 means nothing's bound
+};
+
+class HelperFunctionsHeadless : public HelperFunctions
+{
+public:
+    HelperFunctionsHeadless()
+    {
+        this->window = nullptr;
+    }
+
+    void clearBackground()
+    {
+        HeadlessState::log.record(CommandType::Clear);
+        HeadlessState::program = 0;
+        HeadlessState::texture = 0;
+    }
+
+    void swapBuffer()
+    {
+        HeadlessState::log.record(CommandType::Swap);
+        HeadlessState::log.endFrame();
+    }
+
+    void uploadFrameData(const FrameData &data)
+    {
+        HeadlessState::log.record(CommandType::UploadFrameData, static_cast<uint32_t>(data.lightCount()));
+        HeadlessState::log.current.frameUploads++;
+    }
+
+    void beginPass(bool transparent)
+    {
+        HeadlessState::log.record(CommandType::BeginPass, transparent ? 1 : 0);
+        HeadlessState::log.current.passes++;
+    }
+
+    CommandLog &getLog()
+    {
+        return HeadlessState::log;
+    }
+};
+
+// the path is ignored, there's nothing to load into
+class ImageHeadless : public Image
+{
+public:
+    ImageHeadless(const std::string &/*path*/ = "") : id(HeadlessState::nextId++) {}
+
+    unsigned int getID() const
+    {
+        return id;
+    }
+
+private:
+    unsigned int id;
+};
+
+class MeshBufferHeadless : public MeshBuffer
+{
+public:
+    MeshBufferHeadless(const std::vector<float> &vertices) : id(HeadlessState::nextId++)
+    {
+        update(vertices);
+    }
+
+    unsigned int getID() const
+    {
+        return id;
+    }
+
+    int getVertexCount() const
+    {
+        return vertexCount;
+    }
+
+    void update(const std::vector<float> &vertices)
+    {
+        vertexCount = static_cast<int>(vertices.size() / MeshRegistry::FLOATS_PER_VERTEX);
+        HeadlessState::log.record(CommandType::CreateMesh, id, static_cast<uint32_t>(vertexCount));
+        HeadlessState::log.current.meshUploads++;
+    }
+
+private:
+    unsigned int id;
+    int vertexCount = 0;
+};
+
+// the same constructor as ShaderOpenGl so swapping one for the other is easy, the files don't get read
+// every uniform counts as being in the program, its location is just its id
+class ShaderHeadless : public Shader
+{
+public:
+    ShaderHeadless(const std::string &/*vertexPath*/ = "", const std::string &/*fragmentPath*/ = "") : program(HeadlessState::nextId++) {}
+
+    unsigned int getShader() const
+    {
+        return program;
+    }
+
+    int getUniformLocation(UniformId id) const
+    {
+        return id;
+    }
+
+private:
+    unsigned int program;
+};
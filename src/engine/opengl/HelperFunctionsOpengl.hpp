@@ -7,7 +7,18 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <vector>
+#include <cstddef>
 #include "../HelperFunctions.hpp"
+#include "../InstanceData.hpp"
+
+// what's bound right now, so OpenGlBackend can skip binding the same program or texture again
+// it gets forgotten every clear so a deleted and remade program with the same id can't get skipped for long
+struct GlBindings
+{
+    static inline GLuint program = 0;
+    static inline GLuint texture = 0;
+};
 
 class HelperFunctionsOpenGl : public HelperFunctions
 {
@@ -49,12 +60,20 @@ public:
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
         glEnable(GL_MULTISAMPLE);
         glEnable(GL_STENCIL_TEST);
+
+        // the per frame uniform buffer, every shader's FrameData block reads from this binding
+        glGenBuffers(1, &frameBuffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), nullptr, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_DATA_BINDING, frameBuffer);
     }
 
     void clearBackground()
     {
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        GlBindings::program = 0;
+        GlBindings::texture = 0;
     }
 
     void swapBuffer()
@@ -62,8 +81,24 @@ public:
         SDL_GL_SwapWindow(window);
     }
 
+    void uploadFrameData(const FrameData &data)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, data.usedSize(), &data);
+    }
+
+    void beginPass(bool transparent)
+    {
+        if (transparent)
+            glEnable(GL_BLEND);
+        else
+            glDisable(GL_BLEND);
+        glDepthMask(transparent ? GL_FALSE : GL_TRUE);
+    }
+
     ~HelperFunctionsOpenGl()
     {
+        glDeleteBuffers(1, &frameBuffer);
         SDL_GL_DeleteContext(glContext);
         SDL_DestroyWindow(window);
         SDL_Quit();
@@ -72,6 +107,7 @@ public:
 private:
     SDL_Window *window;
     SDL_GLContext glContext;
+    GLuint frameBuffer = 0;
 };
 
 class ImageOpenGl : public Image
@@ -119,6 +155,116 @@ private:
     GLuint textureID = 0;
 };
 
+class MeshBufferOpenGl : public MeshBuffer
+{
+public:
+    // it uploads the mesh
+    MeshBufferOpenGl(const std::vector<float> &vertices)
+    {
+        vertexCount = vertices.size() / FLOATS_PER_VERTEX;
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+        // Position attribute
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void *)0);
+        glEnableVertexAttribArray(0);
+
+        // Texture coord attribute
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void *)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        // Normal attribute
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, FLOATS_PER_VERTEX * sizeof(float), (void *)(5 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(0);
+    }
+
+    // it unuploads the mesh
+    ~MeshBufferOpenGl()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        if (instanceVBO != 0)
+            glDeleteBuffers(1, &instanceVBO);
+    }
+
+    // it gets the id
+    unsigned int getID() const
+    {
+        return VAO;
+    }
+
+    int getVertexCount() const
+    {
+        return vertexCount;
+    }
+
+    void update(const std::vector<float> &vertices)
+    {
+        // updates the vertices (you dont need to run this unless you changed the vertices)
+        vertexCount = vertices.size() / FLOATS_PER_VERTEX;
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    }
+
+    // puts instances in this mesh's instance buffer, every instanced draw of the mesh shares it
+    // the VAO has to be bound already
+    void uploadInstances(const std::vector<InstanceData> &instances)
+    {
+        if (instanceVBO == 0)
+            setupInstanceBuffer();
+
+        // orphans the old buffer so the driver doesn't have to wait on the last draw before we write
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        GLsizeiptr size = instances.size() * sizeof(InstanceData);
+        glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, instances.data());
+    }
+
+private:
+    static constexpr int FLOATS_PER_VERTEX = 8; // position, uv, normal
+
+    GLuint VAO = 0, VBO = 0;
+    GLuint instanceVBO = 0;
+    int vertexCount = 0;
+
+    // the per instance attributes go after the mesh ones, has to match nearInstancedVertex.glsl
+    void setupInstanceBuffer()
+    {
+        glGenBuffers(1, &instanceVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+        GLsizei stride = sizeof(InstanceData);
+        auto vec4Attribute = [&](GLuint location, size_t offset)
+        {
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride, (void *)offset);
+            glEnableVertexAttribArray(location);
+            glVertexAttribDivisor(location, 1);
+        };
+
+        // a mat4 takes up 4 locations, one per column
+        for (GLuint i = 0; i < 4; i++)
+            vec4Attribute(3 + i, offsetof(InstanceData, model) + i * sizeof(glm::vec4));
+        vec4Attribute(7, offsetof(InstanceData, emission));
+        vec4Attribute(8, offsetof(InstanceData, depth));
+        vec4Attribute(9, offsetof(InstanceData, ambient));
+
+        // the light indices have to stay ints so they use the I version
+        for (GLuint i = 0; i < MAX_OBJECT_LIGHTS / 4; i++)
+        {
+            glVertexAttribIPointer(10 + i, 4, GL_INT, stride, (void *)(offsetof(InstanceData, lights) + i * 4 * sizeof(int)));
+            glEnableVertexAttribArray(10 + i);
+            glVertexAttribDivisor(10 + i, 1);
+        }
+    }
+};
+
 class ShaderOpenGl : public Shader
 {
 public:
@@ -204,6 +350,13 @@ public:
         // Delete shaders; linked into program now and no longer needed
         glDeleteShader(vertex);
         glDeleteShader(fragment);
+
+        // hooks the FrameData block up to the shared per frame buffer
+        GLuint frameBlock = glGetUniformBlockIndex(ID, "FrameData");
+        if (frameBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, frameBlock, FRAME_DATA_BINDING);
+
+        resolveUniforms();
     }
 
     // gets the shader id
@@ -212,6 +365,16 @@ public:
         return ID;
     }
 
+    // comes out of the table, only names the program didn't list when it linked ever ask the driver (and only once)
+    int getUniformLocation(UniformId id) const
+    {
+        if (id >= static_cast<UniformId>(locations.size()))
+            locations.resize(id + 1, UNRESOLVED);
+        if (locations[id] == UNRESOLVED)
+            locations[id] = glGetUniformLocation(ID, UniformNames::name(id).c_str());
+        return locations[id];
+    }
+
     // deletes the thing
     ~ShaderOpenGl()
     {
@@ -219,5 +382,37 @@ public:
     }
 
 private:
+    static constexpr GLint UNRESOLVED = -2;
+
     GLuint ID;
+    mutable std::vector<GLint> locations; // indexed by UniformId
+
+    // asks the program for all its uniforms right after linking, arrays get a location for every element
+    void resolveUniforms()
+    {
+        GLint count = 0;
+        glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+
+        char name[256];
+        for (GLint i = 0; i < count; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type;
+            glGetActiveUniform(ID, i, sizeof(name), &length, &size, &type, name);
+
+            std::string uniform(name, length);
+            size_t bracket = uniform.find('[');
+            if (bracket == std::string::npos)
+            {
+                getUniformLocation(UniformNames::get(uniform));
+                continue;
+            }
+
+            std::string base = uniform.substr(0, bracket);
+            getUniformLocation(UniformNames::get(base));
+            for (GLint j = 0; j < size; j++)
+                getUniformLocation(UniformNames::get(base, j));
+        }
+    }
 };
\ No newline at end of file
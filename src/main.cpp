@@ -2,11 +2,19 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include "engine/RenderObject.h"
+#include "engine/InstanceBatcher.hpp"
+#include "engine/OcclusionCuller.hpp"
+#include "engine/JobSystem.hpp"
+#include "engine/SimulationClock.hpp"
+#include "engine/GravitySolver.hpp"
+#include "engine/Orbit.hpp"
 #include "engine/HelperFunctions.hpp"
 #include "engine/Camera.hpp"
+#include "engine/Profiler.hpp"
 #include "engine/opengl/OpenGlBackend.hpp"
 #include "engine/opengl/HelperFunctionsOpengl.hpp"
 #include <string>
+#include <cstdlib>
 #include <memory>
 
 class Sun : public RenderObject
@@ -15,14 +23,26 @@ public:
     Sun(Shader *shader, Image *image, Camera *camera)
         : RenderObject(new OpenGlBackend(), shader, image, camera, glm::vec3(1.0f), Bigint("384600000000000000000000000"))
     {
-        scale *= Bigint("150000000000");
-        near = 100000;
-        far = 1000000000000;
+        BigVec3 size = getScale();
+        size *= Bigint("150000000000");
+        setScale(size);
+        setNear(100000);
+        setFar(1000000000000);
+        setMass(1.989e30);
     }
 };
 
 int main(int argc, char *argv[])
 {
+    // --trace-after N writes a trace of the first N frames and the phase times and keeps going, F3 does the same whenever
+    int traceAfter = 0;
+    for (int a = 1; a < argc; a++)
+    {
+        if (std::string(argv[a]) == "--trace-after" && a + 1 < argc)
+            traceAfter = std::atoi(argv[++a]);
+    }
+    bool dumpProfile = false;
+
     // it initialises sdl
     if (SDL_Init(SDL_INIT_VIDEO) != 0)
     {
@@ -48,6 +68,9 @@ int main(int argc, char *argv[])
     const float WALK_SPEED = 10;
     const float RUN_SPEED = 100;
 
+    // one set of worker threads for everything that goes wide, it uses every core
+    JobSystem jobs;
+
     // put objects in here to render them
     std::vector<RenderObject *> renderObjects;
 
@@ -60,69 +83,107 @@ int main(int argc, char *argv[])
     }
 
     // this is the camera, cameras are neat
-    Camera *camera = new Camera(RES, Bigint(pos), 0.0f, -2.0f);
+    // it's owned here so it outlives the objects below, they untrack themselves from it when they get destroyed
+    std::unique_ptr<Camera> cameraOwner = std::make_unique<Camera>(RES, Bigint(pos), 0.0f, -2.0f);
+    Camera *camera = cameraOwner.get();
+    camera->floatingOrigin = true; // keeps everything near the camera in doubles so it doesn't redo the Bigint math every frame
     float speed = 10;
 
     // this sets up the shader and texture
     Shader *shader = new ShaderOpenGl("assets/shaders/nearVertex.glsl", "assets/shaders/nearFragment.glsl");
     Image *image = new ImageOpenGl("assets/textures/FISH.png");
 
+    // anything using shader gets drawn with one instanced call per mesh and image
+    Shader *instancedShader = new ShaderOpenGl("assets/shaders/nearInstancedVertex.glsl", "assets/shaders/nearInstancedFragment.glsl");
+    InstanceBatcher batcher;
+    batcher.addVariant(shader, instancedShader);
+
+    // stuff hidden behind the big things (like the sun) doesn't get drawn
+    OcclusionCuller occlusionCuller;
+    RenderObject::occlusionCuller = &occlusionCuller;
+
     // makes the cubes
     RenderObject cube(new OpenGlBackend(), shader, image, camera);
-    // cube.velocity.z = 5;
+    // cube.setVelocity(BigVec3(Bigint(), Bigint(), Bigint(5)));
     renderObjects.push_back(&cube);
 
     cube.disableBrightness = true;
 
     RenderObject cube2(new OpenGlBackend(), shader, image, camera);
-    cube2.position.x -= Bigint(10);
+    BigVec3 cube2Position = cube2.getPosition();
+    cube2Position.x -= Bigint(10);
+    cube2.setPosition(cube2Position);
     renderObjects.push_back(&cube2);
 
     RenderObject cube3(new OpenGlBackend(), shader, image, camera, glm::vec3(1.0f), 10.0f);
     renderObjects.push_back(&cube3);
-    cube3.position.x += Bigint("10");
+    BigVec3 cube3Position = cube3.getPosition();
+    cube3Position.x += Bigint("10");
+    cube3.setPosition(cube3Position);
+    cube3.setParent(&cube); // it gets carried round as the first cube spins
 
     Sun sun(shader, image, camera);
     renderObjects.push_back(&sun);
-    sun.position.x -= Bigint("150000000000"); // Bigint("21392000000");
+
+    // the sun goes round the cubes once a year, on rails so it doesn't drift however much the time is warped
+    OrbitalElements sunElements;
+    sunElements.semiMajorAxis = 1.496e11;
+    sunElements.eccentricity = 0.0167;
+    sunElements.meanAnomalyAtEpoch = 3.14159265358979; // starts furthest away, out along -x
+    Orbit sunOrbit(&sun, nullptr, 1.32712e20, sunElements);
+    sun.setPosition(sunOrbit.positionAt(0.0));
+
+    // world transforms for everything set up above, after this they're only redone when something changes
+    RenderObject::updateTransforms();
 
     // starts running the game loop
     bool running = true;
-    Uint32 lastTicks = SDL_GetTicks();
-    Uint32 currentTicks;
+    SimulationClock simulationClock(60.0, 5); // objects update 60 times a second however fast it draws
+    GravitySolver gravity;                     // only things with a mass pull on each other, the cubes are left alone
+    int steps;
     SDL_Event event;
     float deltaTime;
 
-    glm::mat4 cameraMatrixTmp;
-
-    int i;
-
     while (running)
     {
-        currentTicks = SDL_GetTicks();
-        deltaTime = (currentTicks - lastTicks) / 1000.0f;
-        lastTicks = currentTicks;
+        steps = simulationClock.advance();
+        deltaTime = simulationClock.getFrameTime(); // the camera goes by real time, it isn't part of the simulation
 
         // gets events
-        while (SDL_PollEvent(&event))
         {
-            if (event.type == SDL_QUIT)
-                running = false;
-
-            // rotates camera
-            if (event.type == SDL_MOUSEMOTION)
+            PROFILE_ZONE("events");
+            while (SDL_PollEvent(&event))
             {
-                camera->yaw -= event.motion.xrel * deltaTime * MOUSE_SENSITIVITY;
-                camera->pitch -= event.motion.yrel * deltaTime * MOUSE_SENSITIVITY;
-            }
+                if (event.type == SDL_QUIT)
+                    running = false;
 
-            // when you press escape, leave
-            if (event.type == SDL_KEYDOWN)
-            {
+                // rotates camera
+                if (event.type == SDL_MOUSEMOTION)
+                {
+                    camera->yaw -= event.motion.xrel * deltaTime * MOUSE_SENSITIVITY;
+                    camera->pitch -= event.motion.yrel * deltaTime * MOUSE_SENSITIVITY;
+                }
 
-                if (event.key.keysym.sym == SDLK_ESCAPE)
+                // when you press escape, leave
+                if (event.type == SDL_KEYDOWN)
                 {
-                    running = false;
+
+                    if (event.key.keysym.sym == SDLK_ESCAPE)
+                    {
+                        running = false;
+                    }
+
+                    // time warp goes up and down by 10 times with . and ,
+                    if (event.key.keysym.sym == SDLK_PERIOD || event.key.keysym.sym == SDLK_COMMA)
+                    {
+                        double warp = simulationClock.getTimeWarp() * (event.key.keysym.sym == SDLK_PERIOD ? 10.0 : 0.1);
+                        simulationClock.setTimeWarp(std::max(1.0, std::min(1e7, warp)));
+                        std::cout << "time warp " << simulationClock.getTimeWarp() << "x\n";
+                    }
+
+                    // dumps what the profiler has
+                    if (event.key.keysym.sym == SDLK_F3)
+                        dumpProfile = true;
                 }
             }
         }
@@ -167,29 +228,61 @@ int main(int argc, char *argv[])
             camera->position += (down * deltaTime * speed);
         }
 
-        // update all objects
-        for (i = 0; i < renderObjects.size(); i++)
+        // update everything in fixed steps, straight down the entity store's arrays split over all the cores
+        for (int step = 0; step < steps; step++)
         {
-            renderObjects[i]->Update(deltaTime);
+            PROFILE_ZONE("step");
+            gravity.solve(renderObjects, jobs);
+            RenderObject::entities.integrate(simulationClock.getStep(), RenderObject::scene, jobs);
+            sunOrbit.apply(simulationClock.getStepTime(step));
+            RenderObject::updateTransforms();
+        }
+        RenderObject::interpolation = simulationClock.getAlpha();
+
+        // works out where everything is compared to the camera, all at once
+        camera->updateLocalPositions(jobs);
+
+        // the camera and lights only get sent once for everyone
+        RenderObject::uploadFrameData(*camera, renderingEngine);
+        {
+            PROFILE_ZONE("occlusion");
+            occlusionCuller.prepare(*camera, renderObjects);
         }
 
         // clear background
         renderingEngine->clearBackground();
 
-        // draw all objects
-        for (i = 0; i < renderObjects.size(); i++)
+        // draw all objects, they get sorted by state and depth, recorded over all the cores and drawn in one go by the flush
+        batcher.submit(renderObjects, &jobs);
+        RenderObject::renderQueue.flush(renderingEngine, jobs);
+
+        // swap buffer
         {
-            renderObjects[i]->Draw();
+            PROFILE_ZONE("swapBuffer");
+            renderingEngine->swapBuffer();
         }
+        PROFILE_END_FRAME();
 
-        // swap buffer
-        renderingEngine->swapBuffer();
+        // open the trace in chrome://tracing or ui.perfetto.dev
+        if (traceAfter > 0 && --traceAfter == 0)
+            dumpProfile = true;
+        if (dumpProfile)
+        {
+            dumpProfile = false;
+            if (Profiler::writeChromeTrace("profile.json"))
+                std::cout << "wrote profile.json\n";
+            else
+                std::cerr << "couldn't write profile.json\n";
+            Profiler::printStats(std::cout);
+            std::cout << "occlusion: " << occlusionCuller.getCulled() << " of " << occlusionCuller.getTested() << " hidden ("
+                      << occlusionCuller.getCullRate() * 100.0f << "%) by " << occlusionCuller.getOccluderCount() << " occluders\n";
+        }
     }
 
     // delete everything
     delete shader;
+    delete instancedShader;
     delete image;
     delete renderingEngine;
-    delete camera;
     return 0;
 }
\ No newline at end of file